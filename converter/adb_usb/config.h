@@ -30,6 +30,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define MATRIX_ROWS 16  // keycode bit: 3-0
 #define MATRIX_COLS 8   // keycode bit: 6-4
 
+/* matrix.c marks modified rows */
+#define MATRIX_DIRTY_ROWS
+
 #define MATRIX_ROW(code)    ((code)>>3&0x0F)
 #define MATRIX_COL(code)    ((code)&0x07)
 
@@ -55,6 +58,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define ADB_DATA_BIT    0
 #define ADB_PSW_BIT     1
 
+/* polling interval(ms) just after data from device and at most while idle, see matrix.c
+ * shorter ADB_POLL_MIN reduces latency but some keyboards miss strokes with it and
+ * it is not verified with mice, see README */
+//#define ADB_POLL_MIN    6
+//#define ADB_POLL_IDLE   11
+
 /* key combination for command */
 #ifndef __ASSEMBLER__
 #include "adb.h"
@@ -47,6 +47,7 @@ static void register_key(uint8_t key)
     } else {
         matrix[row] |=  (1<<col);
     }
+    matrix_set_dirty(row);
 }
 
 
@@ -57,17 +58,28 @@ static struct adb_device {
     uint8_t handler;
 } device_table[16] = {0};
 
+// Polling statistics and time of last data
+static struct poll_stat {
+    uint32_t last;
+    uint16_t polls;
+    uint16_t hits;
+    uint16_t srq_seen;      // SRQ while polling it, asserted by other device
+} poll_stat[16] = {0};
+
 static void print_device_table(void)
 {
     xprintf("\nTable:\n");
-    xprintf("A:H  a:h\n");
-    xprintf("---------\n");
+    xprintf("A:H  a:h  poll  hit  srq seen\n");
+    xprintf("----------------------------\n");
     for (uint8_t addr = 0; addr < 16; addr++) {
         if (device_table[addr].addr_default == 0) continue;
-        xprintf("%X:%02X %X:%02X\n", addr,
+        xprintf("%X:%02X %X:%02X %5u %5u %5u\n", addr,
                 device_table[addr].handler,
                 device_table[addr].addr_default,
-                device_table[addr].handler_default);
+                device_table[addr].handler_default,
+                poll_stat[addr].polls,
+                poll_stat[addr].hits,
+                poll_stat[addr].srq_seen);
     }
     xprintf("\n");
 }
@@ -824,89 +836,198 @@ void led_set(uint8_t usb_led)
     adb_host_kbd_led(ADB_ADDR_KEYBOARD, ~usb_led);
 }
 
-uint8_t matrix_scan(void)
+// device to poll at the address
+static bool poll_target(uint8_t addr)
 {
-    static uint16_t poll_ms;
-    static uint16_t detect_ms;
-    static uint8_t active_addr = 3;
-    static bool psw_state = false;
+    // Ignore Address 0
+    if (addr == 0) return false;
+    if (device_table[addr].addr_default) return true;
 
+    // 'Dumb' device may exist at 2, 3 and 7 #733
+    return (addr == ADB_ADDR_KEYBOARD || addr == ADB_ADDR_MOUSE || addr == ADB_ADDR_APPLIANCE);
+}
+
+static uint8_t poll_device(uint8_t addr)
+{
     uint8_t len;
     uint8_t buf[8];
-    uint8_t addr = active_addr;
-    uint8_t busy = 0;
+    uint8_t addr_default = device_table[addr].addr_default;
+
+    switch (addr_default ? addr_default : addr) {
+    case ADB_ADDR_KEYBOARD:
+        return keyboard_proc(addr);
+    case ADB_ADDR_MOUSE:
+        return mouse_proc(addr);
+    case ADB_ADDR_APPLIANCE:
+        return appliance_proc(addr);
+    default:
+        // Unsupported device
+        len = adb_host_talk_buf(addr, ADB_REG_0, buf, sizeof(buf));
+        if (len) {
+            xprintf("U:$%X:%02X:[ ", addr, device_table[addr].handler);
+            for (uint8_t i = 0; i < len; i++) {
+                xprintf("%02X ", buf[i]);
+            }
+            xprintf("]\n");
+            return 1;
+        }
+        return 0;
+    }
+}
 
-    // Polling with 11ms interval
-    if (timer_elapsed(poll_ms) >= 11) {
-        poll_ms = timer_read();
-        do {
-            addr %= 16;
+/*
+ * Polling scheduler
+ *
+ * A round polls device which sent data most recently first and goes on to
+ * other devices in order of their last data while SRQ is asserted. Interval
+ * of rounds is ADB_POLL_MIN ms after data from any device and backs off 1ms
+ * per round without data up to ADB_POLL_IDLE.
+ *
+ * Both are 11ms by default like fixed interval of old converter, so that
+ * only order of polls changes. Some keyboards miss strokes with shorter
+ * interval, give smaller ADB_POLL_MIN in config.h to opt in.
+ *
+ * Statistics of polls, data(hit) and SRQ seen while polling each device are
+ * shown in table printed on release of Power key.
+ */
+#ifndef ADB_POLL_MIN
+#define ADB_POLL_MIN    11
+#endif
+#ifndef ADB_POLL_IDLE
+#define ADB_POLL_IDLE   11
+#endif
+#if (ADB_POLL_MIN > ADB_POLL_IDLE)
+#   error "ADB_POLL_MIN is larger than ADB_POLL_IDLE."
+#endif
 
-            // Ignore Address 0
-            if (addr == 0) continue;
+static uint8_t poll_interval = ADB_POLL_IDLE;
+static uint16_t round_polled;
+static uint8_t round_busy;
 
-            switch (device_table[addr].addr_default) {
-            case ADB_ADDR_KEYBOARD:
-                busy = keyboard_proc(addr);
-                break;
-            case ADB_ADDR_MOUSE:
-                busy = mouse_proc(addr);
-                break;
-            case ADB_ADDR_APPLIANCE:
-                busy = appliance_proc(addr);
-                break;
-            case 0:
-                // 'Dumb' device may exist at 2, 3 and 7 #733
-                switch (addr) {
-                case ADB_ADDR_KEYBOARD:
-                    busy = keyboard_proc(addr);
-                    break;
-                case ADB_ADDR_MOUSE:
-                    busy = mouse_proc(addr);
-                    break;
-                case ADB_ADDR_APPLIANCE:
-                    busy = appliance_proc(addr);
-                    break;
-                default:
-                    // No device - Poll next address
-                    continue;
-                }
-                break;
-            default:
-                // Unsupported device
-                len = adb_host_talk_buf(addr, ADB_REG_0, buf, sizeof(buf));
-                if (len) {
-                    xprintf("U:$%X:%02X:[ ", addr, device_table[addr].handler);
-                    for (uint8_t i = 0; i < len; i++) {
-                        xprintf("%02X ", buf[i]);
-                    }
-                    xprintf("]\n");
-                    busy = 1;
-                }
-                break;
-            }
+static void round_start(void)
+{
+    round_polled = 0;
+    round_busy = 0;
+}
 
+static void round_end(void)
+{
+    if (round_busy) {
+        poll_interval = ADB_POLL_MIN;
+    } else if (poll_interval < ADB_POLL_IDLE) {
+        poll_interval++;
+    }
+}
+
+// next device in round, 0 if none
+static uint8_t poll_next(void)
+{
+    uint8_t next = 0;
+    uint32_t age = 0;
+    for (uint8_t addr = 1; addr < 16; addr++) {
+        if ((round_polled & ((uint16_t)1<<addr)) || !poll_target(addr)) continue;
+        uint32_t a = timer_elapsed32(poll_stat[addr].last);
+        if (!next || a < age) {
+            next = addr;
+            age = a;
+        }
+    }
+    return next;
+}
+
+static uint8_t poll(uint8_t addr)
+{
+    round_polled |= ((uint16_t)1<<addr);
+    uint8_t busy = poll_device(addr);
+
+    struct poll_stat *st = &poll_stat[addr];
+    st->polls++;
+    if (busy) {
+        st->hits++;
+        st->last = timer_read32();
+    }
+    // other device has data
+    if (adb_service_request()) st->srq_seen++;
+
+    round_busy |= busy;
+    return busy;
+}
+
+// Check PSW pin for NeXT keyboard
+// https://github.com/tmk/tmk_keyboard/issues/735
+static void psw_task(void)
+{
+    static bool psw_state = false;
+
+    if (!psw_state) {
+        if (!adb_host_psw()) {
+            register_key(0x7F); // power key press
+            psw_state = true;
+        }
+    } else {
+        if (adb_host_psw()) {
+            register_key(0xFF); // power key release
+            psw_state = false;
+        }
+    }
+}
+
+uint8_t matrix_scan(void)
+{
+    static uint16_t poll_ms;
+    static uint16_t detect_ms;
+
+    uint8_t busy = 0;
+
+#ifdef ADB_USE_TIMER
+    // Talk to device runs in background and its proc collects response.
+    static uint8_t poll_addr;
+    static bool polling = false;
+    uint8_t next = 0;
+
+    if (polling) {
+        if (adb_host_busy()) return 1;
+        polling = false;
+        busy = poll(poll_addr);
+        if (adb_service_request()) {
+            next = poll_next();
+        }
+        if (!next) {
+            round_end();
+        }
+    } else if (timer_elapsed(poll_ms) >= poll_interval) {
+        poll_ms = timer_read();
+        round_start();
+        next = poll_next();
+        psw_task();
+    }
+    if (next) {
+        // Talk can't be started while response of device polled last is
+        // left, its proc collects the response first.
+        if (!adb_host_talk_start(next, ADB_REG_0)) {
+            next = poll_addr;
+        }
+        poll_addr = next;
+        polling = true;
+        return 1;
+    }
+#else
+    if (timer_elapsed(poll_ms) >= poll_interval) {
+        poll_ms = timer_read();
+        round_start();
+        uint8_t addr;
+        while ((addr = poll_next())) {
+            busy |= poll(addr);
             if (!adb_service_request()) {
                 // No SRQ - Done.
                 break;
             }
-        } while (++addr != active_addr);
-        active_addr = addr % 16;
-
-        // Check PSW pin for NeXT keyboard
-        // https://github.com/tmk/tmk_keyboard/issues/735
-        if (!psw_state) {
-            if (!adb_host_psw()) {
-                register_key(0x7F); // power key press
-                psw_state = true;
-            }
-        } else {
-            if (adb_host_psw()) {
-                register_key(0xFF); // power key release
-                psw_state = false;
-            }
         }
+        round_end();
+
+        psw_task();
     }
+#endif
 
     // Address Resolution
     if (!busy) {
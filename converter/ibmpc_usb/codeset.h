@@ -0,0 +1,200 @@
+/* Generated from codeset.txt by tool/host/ibmpc_codeset.c, don't edit. */
+#ifndef CODESET_H
+#define CODESET_H
+
+#include "ibmpc_codeset.h"
+
+// states: 39(234 bytes)  rows: 27  exceptions: 505 in 1037 entries(2074 bytes)
+
+static const ibmpc_cs_variant_t ibmpc_cs_variants[] PROGMEM = {
+    { 1, true , 0x0000,   0 },
+    { 2, false, 0xAB90,   5 },
+    { 2, false, 0xAB91,   5 },
+    { 2, true , 0x0000,  16 },
+    { 3, false, 0xAB91,  27 },
+    { 3, false, 0xAB92,  31 },
+    { 3, true , 0x0000,  35 },
+};
+#define IBMPC_CS_VARIANTS   7
+
+static const ibmpc_cs_state_t ibmpc_cs_states[] PROGMEM = {
+    // lo,  hi,   event,          row,  base
+    { 0xE0, 0xE0, IBMPC_CS_BIT7,    0, 65318 },  //   0: 1 INIT
+    { 0xD0, 0xD0, IBMPC_CS_BIT7,    1,   355 },  //   1: 1 E0
+    { 0xC0, 0xC0, IBMPC_CS_MAKE,    2, 65509 },  //   2: 1 E1
+    { 0xC0, 0xC0, IBMPC_CS_MAKE,    3, 65472 },  //   3: 1 E1_1D
+    { 0xC0, 0xC0, IBMPC_CS_BREAK,   4, 65349 },  //   4: 1 E1_9D
+    { 0xE0, 0xC5, IBMPC_CS_MAKE,    5,   264 },  //   5: 2 INIT
+    { 0xE0, 0xC5, IBMPC_CS_BREAK,   6,   576 },  //   6: 2 F0
+    { 0xE0, 0xC5, IBMPC_CS_MAKE,    7,     0 },  //   7: 2 E0
+    { 0xE0, 0xC5, IBMPC_CS_BREAK,   8,   129 },  //   8: 2 E0_F0
+    { 0xC0, 0xC0, IBMPC_CS_MAKE,    9, 65517 },  //   9: 2 E1
+    { 0xC0, 0xC0, IBMPC_CS_MAKE,   10, 65431 },  //  10: 2 E1_14
+    { 0xC0, 0xC0, IBMPC_CS_BREAK,  11, 65531 },  //  11: 2 E1_F0
+    { 0xC0, 0xC0, IBMPC_CS_BREAK,  12, 65315 },  //  12: 2 E1_F0_14
+    { 0xC0, 0xC0, IBMPC_CS_BREAK,  10, 65431 },  //  13: 2 E1_F0_14_F0
+    { 0xE0, 0xE0, IBMPC_CS_MAKE,   13,   416 },  //  14: 2 80
+    { 0xE0, 0xE0, IBMPC_CS_BREAK,  14,   812 },  //  15: 2 80_F0
+    { 0xE0, 0xC5, IBMPC_CS_MAKE,   15,    85 },  //  16: 2 INIT
+    { 0xE0, 0xC5, IBMPC_CS_BREAK,  16, 65413 },  //  17: 2 F0
+    { 0xE0, 0xC5, IBMPC_CS_MAKE,   17,   256 },  //  18: 2 E0
+    { 0xE0, 0xC5, IBMPC_CS_BREAK,  18,   568 },  //  19: 2 E0_F0
+    { 0xC0, 0xC0, IBMPC_CS_MAKE,    9, 65517 },  //  20: 2 E1
+    { 0xC0, 0xC0, IBMPC_CS_MAKE,   10, 65431 },  //  21: 2 E1_14
+    { 0xC0, 0xC0, IBMPC_CS_BREAK,  11, 65531 },  //  22: 2 E1_F0
+    { 0xC0, 0xC0, IBMPC_CS_BREAK,  12, 65315 },  //  23: 2 E1_F0_14
+    { 0xC0, 0xC0, IBMPC_CS_BREAK,  10, 65431 },  //  24: 2 E1_F0_14_F0
+    { 0xE0, 0xE0, IBMPC_CS_MAKE,   13,   416 },  //  25: 2 80
+    { 0xE0, 0xE0, IBMPC_CS_BREAK,  14,   812 },  //  26: 2 80_F0
+    { 0xE0, 0xC7, IBMPC_CS_MAKE,   19,   609 },  //  27: 3 READY
+    { 0xE0, 0xC7, IBMPC_CS_BREAK,  20,   675 },  //  28: 3 F0
+    { 0xC8, 0xC8, IBMPC_CS_MAKE,   21,    61 },  //  29: 3 G80
+    { 0xC8, 0xC8, IBMPC_CS_BREAK,  22,   376 },  //  30: 3 G80_F0
+    { 0xE0, 0xC7, IBMPC_CS_MAKE,   23,   773 },  //  31: 3 READY
+    { 0xE0, 0xC7, IBMPC_CS_BREAK,  24,   784 },  //  32: 3 F0
+    { 0xC8, 0xC8, IBMPC_CS_MAKE,   21,    61 },  //  33: 3 G80
+    { 0xC8, 0xC8, IBMPC_CS_BREAK,  22,   376 },  //  34: 3 G80_F0
+    { 0xE0, 0xC7, IBMPC_CS_MAKE,   25,   697 },  //  35: 3 READY
+    { 0xE0, 0xC7, IBMPC_CS_BREAK,  26,   590 },  //  36: 3 F0
+    { 0xC8, 0xC8, IBMPC_CS_MAKE,   21,    61 },  //  37: 3 G80
+    { 0xC8, 0xC8, IBMPC_CS_BREAK,  22,   376 },  //  38: 3 G80_F0
+};
+
+#define IBMPC_CS_ENTRIES    1037
+static const uint8_t ibmpc_cs_entries[] PROGMEM = {
+    /*    0 */ 0x65, 0x85, 0x83, 0x18, 0x08, 0x55, 0x81, 0x82, 0x02, 0x7F, 0x55, 0x20, 0x10, 0x19, 0x00, 0x87,
+    /*   16 */ 0x08, 0x13, 0xC0, 0x88, 0x19, 0x18, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x30, 0x00, 0x00, 0x17,
+    /*   32 */ 0x18, 0x65, 0x00, 0x6F, 0x28, 0xC4, 0x00, 0x1F, 0x20, 0x00, 0x00, 0x50, 0x00, 0x00, 0x00, 0x27,
+    /*   48 */ 0x28, 0x00, 0x6E, 0x00, 0x08, 0x00, 0x00, 0x5F, 0x30, 0x00, 0x38, 0x10, 0x00, 0x00, 0x00, 0x57,
+    /*   64 */ 0x00, 0x7C, 0x48, 0x40, 0x50, 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0x57, 0x00, 0x20, 0x00, 0x00,
+    /*   80 */ 0x28, 0x00, 0x00, 0x51, 0x00, 0xC4, 0x00, 0x00, 0x00, 0xC0, 0x62, 0x00, 0x00, 0x00, 0x50, 0x00,
+    /*   96 */ 0x00, 0x00, 0x53, 0x5D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x5C, 0x00, 0x53, 0x2F, 0x00, 0x00, 0x00,
+    /*  112 */ 0x39, 0x37, 0x3F, 0x00, 0x47, 0x4F, 0x00, 0x00, 0x00, 0x6D, 0x56, 0x00, 0x7F, 0x5E, 0x00, 0x00,
+    /*  128 */ 0x00, 0x65, 0x84, 0x00, 0x18, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x10, 0x19, 0x00,
+    /*  144 */ 0x00, 0x08, 0x13, 0xC0, 0x00, 0x19, 0x18, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x30, 0x00, 0x00,
+    /*  160 */ 0x17, 0x18, 0x65, 0x00, 0x6F, 0x28, 0x00, 0x00, 0x1F, 0x20, 0x00, 0x00, 0x50, 0x00, 0x00, 0x00,
+    /*  176 */ 0x27, 0x28, 0x00, 0x6E, 0x00, 0x08, 0x00, 0x00, 0x5F, 0x30, 0x00, 0x38, 0x10, 0x00, 0x00, 0x00,
+    /*  192 */ 0x57, 0x00, 0x7C, 0x48, 0x40, 0x50, 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0x57, 0x00, 0x20, 0x00,
+    /*  208 */ 0x00, 0x28, 0x00, 0x00, 0x00, 0x89, 0x00, 0x00, 0x02, 0x7F, 0xC0, 0x62, 0x00, 0x86, 0x00, 0x50,
+    /*  224 */ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC6, 0xC6, 0x00, 0x5C, 0x00, 0x53, 0x2F, 0x00, 0x00,
+    /*  240 */ 0x83, 0x39, 0x37, 0x3F, 0x00, 0x47, 0x4F, 0x00, 0x00, 0x00, 0x6D, 0x56, 0xC6, 0x7F, 0x5E, 0x00,
+    /*  256 */ 0x65, 0x00, 0x00, 0x18, 0x08, 0x00, 0x00, 0x00, 0xC4, 0x00, 0x00, 0x20, 0x10, 0x19, 0x00, 0x00,
+    /*  272 */ 0x08, 0x0F, 0xC0, 0x00, 0x19, 0x18, 0x54, 0x00, 0x10, 0x0F, 0x00, 0x11, 0x30, 0x00, 0x00, 0x17,
+    /*  288 */ 0x18, 0x65, 0x00, 0x6F, 0x28, 0x00, 0x00, 0x1F, 0x20, 0x00, 0x00, 0x50, 0x00, 0x83, 0x00, 0x27,
+    /*  304 */ 0x28, 0x00, 0x6E, 0x00, 0x08, 0x82, 0x84, 0x5F, 0x30, 0xC6, 0x38, 0x10, 0x00, 0x00, 0x00, 0x57,
+    /*  320 */ 0x00, 0x00, 0x48, 0x40, 0x50, 0x81, 0x00, 0x00, 0x00, 0x00, 0x60, 0x57, 0x00, 0x20, 0x00, 0x00,
+    /*  336 */ 0x28, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0x62, 0x00, 0x5B, 0x00, 0x50, 0x00,
+    /*  352 */ 0x00, 0x00, 0x00, 0x5D, 0x6A, 0x6A, 0x00, 0x00, 0x00, 0x5C, 0x0E, 0x53, 0x2F, 0x00, 0x00, 0x00,
+    /*  368 */ 0x39, 0x37, 0x3F, 0x00, 0x47, 0x4F, 0x00, 0x00, 0x00, 0x6D, 0x56, 0x00, 0x7F, 0x5E, 0x00, 0x6F,
+    /*  384 */ 0x7A, 0x00, 0x00, 0x5D, 0x77, 0x00, 0x00, 0x00, 0x89, 0x00, 0x00, 0x02, 0x7F, 0xC0, 0x51, 0x00,
+    /*  400 */ 0x00, 0x5E, 0x00, 0x5F, 0x00, 0x00, 0x00, 0x00, 0x7F, 0xC0, 0x54, 0x7C, 0x00, 0x53, 0x5D, 0x00,
+    /*  416 */ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x55, 0x74, 0x60, 0x77, 0x00, 0x61, 0x00,
+    /*  432 */ 0x63, 0x00, 0x75, 0x62, 0x78, 0x71, 0x72, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x6F, 0x5F, 0x5A, 0x5B,
+    /*  448 */ 0x5C, 0x70, 0x79, 0x27, 0x17, 0x00, 0x7B, 0x00, 0x00, 0x00, 0x48, 0x08, 0x28, 0x51, 0x00, 0x00,
+    /*  464 */ 0x00, 0x00, 0x50, 0x18, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x57, 0x00, 0x30, 0x00, 0x00, 0x00,
+    /*  480 */ 0x00, 0x00, 0x20, 0x38, 0x65, 0x00, 0x00, 0x00, 0x82, 0x84, 0x00, 0x40, 0x00, 0x6E, 0x00, 0x00,
+    /*  496 */ 0x83, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x81, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x6F,
+    /*  512 */ 0x7A, 0x6A, 0x00, 0x5D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x00,
+    /*  528 */ 0x00, 0x5E, 0x00, 0x5F, 0x00, 0x00, 0x00, 0x00, 0x7F, 0xC0, 0x54, 0x7C, 0x00, 0x00, 0x00, 0x00,
+    /*  544 */ 0x00, 0x00, 0xC6, 0xC6, 0x00, 0x00, 0x00, 0x00, 0x00, 0x55, 0x74, 0x60, 0x77, 0x00, 0x61, 0x00,
+    /*  560 */ 0x63, 0x00, 0x75, 0x62, 0x78, 0x71, 0x72, 0xC6, 0x65, 0x00, 0x00, 0x18, 0x08, 0x00, 0x5A, 0x5B,
+    /*  576 */ 0x5C, 0x70, 0x79, 0x20, 0x10, 0x19, 0x7B, 0x00, 0x08, 0x0F, 0xC0, 0x00, 0x19, 0x18, 0x54, 0x00,
+    /*  592 */ 0x10, 0x0F, 0x00, 0x11, 0x30, 0x00, 0x00, 0x17, 0x18, 0x65, 0x00, 0x6F, 0x28, 0x00, 0x00, 0x1F,
+    /*  608 */ 0x20, 0xC4, 0x00, 0x50, 0x00, 0x00, 0x00, 0x27, 0x28, 0x76, 0x6E, 0x00, 0x08, 0x00, 0x00, 0x5F,
+    /*  624 */ 0x30, 0x00, 0x38, 0x10, 0xC6, 0x00, 0x00, 0x57, 0x00, 0x00, 0x48, 0x40, 0x50, 0x00, 0x00, 0x00,
+    /*  640 */ 0x00, 0x00, 0x60, 0x57, 0x00, 0x20, 0x00, 0x00, 0x28, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    /*  656 */ 0x8A, 0xC0, 0x62, 0x00, 0x5B, 0x00, 0x50, 0x00, 0x00, 0x00, 0x00, 0x5D, 0x6A, 0x6A, 0x00, 0x00,
+    /*  672 */ 0x00, 0x5C, 0x0E, 0x53, 0x2F, 0x00, 0x00, 0x00, 0x39, 0x37, 0x3F, 0x76, 0x47, 0x4F, 0x00, 0x00,
+    /*  688 */ 0x00, 0x6D, 0x56, 0x00, 0x7F, 0x5E, 0x00, 0x00, 0x5C, 0xC4, 0x00, 0x00, 0x77, 0x53, 0x00, 0x00,
+    /*  704 */ 0x00, 0x00, 0x00, 0x02, 0x7F, 0x6E, 0x6D, 0x00, 0x62, 0x00, 0x00, 0x00, 0x00, 0x00, 0x64, 0x65,
+    /*  720 */ 0x00, 0x02, 0x7F, 0x68, 0x78, 0x00, 0x00, 0x00, 0x58, 0x01, 0x09, 0x0A, 0x00, 0x68, 0x00, 0x00,
+    /*  736 */ 0x00, 0x82, 0x00, 0x00, 0x02, 0x7C, 0x08, 0x10, 0x02, 0x7E, 0x0C, 0x03, 0x04, 0x05, 0x77, 0x67,
+    /*  752 */ 0x7F, 0x7B, 0x01, 0x09, 0x00, 0x00, 0x00, 0x00, 0xC6, 0xC6, 0x5C, 0x00, 0x00, 0x00, 0x00, 0x53,
+    /*  768 */ 0x00, 0x00, 0x00, 0x00, 0x00, 0xC4, 0x00, 0x6E, 0x6D, 0x00, 0x62, 0xC6, 0xC6, 0xC6, 0x00, 0x00,
+    /*  784 */ 0x64, 0x65, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x5D, 0x00, 0x58, 0x00, 0x00, 0x00, 0x00, 0x68,
+    /*  800 */ 0xC6, 0x00, 0x00, 0x5D, 0x00, 0x00, 0x02, 0x7C, 0x08, 0x10, 0x02, 0x7E, 0x0C, 0x03, 0x04, 0x05,
+    /*  816 */ 0x77, 0x67, 0x7F, 0x7B, 0x01, 0x09, 0x00, 0x00, 0x00, 0x82, 0x00, 0x00, 0x02, 0x7F, 0x68, 0x78,
+    /*  832 */ 0x00, 0x00, 0x00, 0x00, 0x01, 0x09, 0x0A, 0x1F, 0x6F, 0x5F, 0xC6, 0x00, 0x00, 0xC6, 0xC6, 0x27,
+    /*  848 */ 0x17, 0x81, 0x00, 0x00, 0x00, 0x00, 0x48, 0x08, 0x28, 0x51, 0x00, 0x00, 0x00, 0xC6, 0x50, 0x18,
+    /*  864 */ 0x10, 0x51, 0xC6, 0xC6, 0xC6, 0x00, 0x57, 0x00, 0x30, 0x00, 0x00, 0x00, 0x51, 0x00, 0x20, 0x38,
+    /*  880 */ 0x65, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0xC6, 0x6E, 0x00, 0x7E, 0x00, 0x00, 0x00, 0x00,
+    /*  896 */ 0x00, 0x00, 0x00, 0x76, 0x00, 0x82, 0x7E, 0x00, 0x02, 0x7F, 0x68, 0x78, 0x00, 0x6A, 0x76, 0x00,
+    /*  912 */ 0x01, 0x09, 0x0A, 0x02, 0x7F, 0x68, 0x78, 0x00, 0x00, 0x00, 0x00, 0x01, 0x09, 0x0A, 0x00, 0xC6,
+    /*  928 */ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x81, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC6,
+    /*  944 */ 0xC6, 0x00, 0x00, 0x00, 0x00, 0xC6, 0x00, 0x00, 0x00, 0x00, 0xC6, 0xC6, 0x00, 0x00, 0x00, 0x00,
+    /*  960 */ 0x00, 0x00, 0x00, 0x00, 0xC6, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC6,
+    /*  976 */ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    /*  992 */ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    /* 1008 */ 0x00, 0x00, 0x00, 0x00, 0x00, 0x81, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    /* 1024 */ 0x00, 0xC6, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC6,
+};
+
+static const uint8_t ibmpc_cs_rows[] PROGMEM = {
+    /*    0 */ 0x07, 0x09, 0x02, 0x07, 0x07, 0x03, 0x00, 0x00, 0x10, 0x10, 0x04, 0x07, 0x07, 0x07, 0x0A, 0x0B,
+    /*   16 */ 0x07, 0x07, 0x07, 0x0C, 0x07, 0x07, 0xFF, 0xFF, 0x07, 0xFF, 0xFF, 0xFF, 0x07, 0xFF, 0xFF, 0x07,
+    /*   32 */ 0x07, 0x07, 0xFF, 0x07, 0x07, 0x00, 0xFF, 0x07, 0x07, 0xFF, 0xFF, 0x07, 0xFF, 0xFF, 0xFF, 0x07,
+    /*   48 */ 0x07, 0xFF, 0x07, 0xFF, 0x07, 0xFF, 0xFF, 0x07, 0x07, 0xFF, 0x07, 0x07, 0xFF, 0xFF, 0xFF, 0x07,
+    /*   64 */ 0xFF, 0x07, 0x07, 0x07, 0x07, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x07, 0x07, 0xFF, 0x07, 0xFF, 0xFF,
+    /*   80 */ 0x07, 0xFF, 0xFF, 0x15, 0xFF, 0x0F, 0xFF, 0xFF, 0xFF, 0x07, 0x07, 0x15, 0xFF, 0xFF, 0x07, 0xFF,
+    /*   96 */ 0xFF, 0xFF, 0x15, 0x15, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x07, 0xFF, 0x07, 0x07, 0xFF, 0xFF, 0xFF,
+    /*  112 */ 0x07, 0x07, 0x07, 0xFF, 0x07, 0x07, 0xFF, 0x07, 0xFF, 0x07, 0x07, 0xFF, 0x07, 0x07, 0x07, 0xFF,
+    /*  128 */ 0xFF, 0x08, 0x02, 0xFF, 0x08, 0x08, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x08, 0x08, 0x08, 0xFF,
+    /*  144 */ 0xFF, 0x08, 0x08, 0x08, 0xFF, 0x08, 0x08, 0xFF, 0xFF, 0x08, 0xFF, 0xFF, 0xFF, 0x08, 0xFF, 0xFF,
+    /*  160 */ 0x08, 0x08, 0x08, 0xFF, 0x08, 0x08, 0xFF, 0xFF, 0x08, 0x08, 0xFF, 0xFF, 0x08, 0xFF, 0xFF, 0xFF,
+    /*  176 */ 0x08, 0x08, 0xFF, 0x08, 0xFF, 0x08, 0xFF, 0xFF, 0x08, 0x08, 0xFF, 0x08, 0x08, 0xFF, 0xFF, 0xFF,
+    /*  192 */ 0x08, 0xFF, 0x08, 0x08, 0x08, 0x08, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x08, 0x08, 0xFF, 0x08, 0xFF,
+    /*  208 */ 0xFF, 0x08, 0xFF, 0xFF, 0xFF, 0x0F, 0xFF, 0xFF, 0x0F, 0x0F, 0x08, 0x08, 0xFF, 0x09, 0xFF, 0x08,
+    /*  224 */ 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x15, 0x15, 0xFF, 0x08, 0xFF, 0x08, 0x08, 0xFF, 0xFF,
+    /*  240 */ 0x07, 0x08, 0x08, 0x08, 0xFF, 0x08, 0x08, 0xFF, 0x08, 0xFF, 0x08, 0x08, 0x15, 0x08, 0x08, 0x08,
+    /*  256 */ 0x11, 0xFF, 0xFF, 0x11, 0x11, 0xFF, 0xFF, 0xFF, 0x05, 0xFF, 0xFF, 0x11, 0x11, 0x11, 0xFF, 0xFF,
+    /*  272 */ 0x11, 0x11, 0x11, 0xFF, 0x11, 0x11, 0x05, 0xFF, 0x11, 0x05, 0xFF, 0x05, 0x11, 0xFF, 0xFF, 0x11,
+    /*  288 */ 0x11, 0x11, 0xFF, 0x11, 0x11, 0xFF, 0xFF, 0x11, 0x11, 0xFF, 0xFF, 0x11, 0xFF, 0x15, 0xFF, 0x11,
+    /*  304 */ 0x11, 0xFF, 0x11, 0xFF, 0x11, 0x0F, 0x0F, 0x11, 0x11, 0x15, 0x11, 0x11, 0xFF, 0xFF, 0xFF, 0x11,
+    /*  320 */ 0xFF, 0xFF, 0x11, 0x11, 0x11, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0x11, 0x11, 0xFF, 0x11, 0xFF, 0xFF,
+    /*  336 */ 0x11, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x11, 0x11, 0xFF, 0x05, 0xFF, 0x11, 0xFF,
+    /*  352 */ 0xFF, 0xFF, 0xFF, 0x05, 0x05, 0x05, 0xFF, 0xFF, 0xFF, 0x11, 0x05, 0x11, 0x11, 0xFF, 0xFF, 0xFF,
+    /*  368 */ 0x11, 0x11, 0x11, 0xFF, 0x11, 0x11, 0xFF, 0x11, 0xFF, 0x11, 0x11, 0xFF, 0x11, 0x11, 0x11, 0x01,
+    /*  384 */ 0x01, 0xFF, 0xFF, 0x01, 0x05, 0xFF, 0xFF, 0xFF, 0x05, 0xFF, 0xFF, 0x05, 0x05, 0x01, 0x16, 0xFF,
+    /*  400 */ 0xFF, 0x01, 0xFF, 0x01, 0xFF, 0xFF, 0x16, 0xFF, 0x01, 0x01, 0x01, 0x01, 0xFF, 0x16, 0x16, 0xFF,
+    /*  416 */ 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x01, 0x01, 0x01, 0xFF, 0x01, 0xFF,
+    /*  432 */ 0x01, 0xFF, 0x01, 0x01, 0x01, 0x01, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0x0D, 0x0D, 0x0D, 0x01, 0x01,
+    /*  448 */ 0x01, 0x01, 0x01, 0x0D, 0x0D, 0xFF, 0x01, 0xFF, 0xFF, 0xFF, 0x0D, 0x0D, 0x0D, 0x0D, 0xFF, 0xFF,
+    /*  464 */ 0xFF, 0xFF, 0x0D, 0x0D, 0x0D, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x0D, 0xFF, 0x0D, 0xFF, 0xFF, 0xFF,
+    /*  480 */ 0xFF, 0xFF, 0x0D, 0x0D, 0x0D, 0xFF, 0xFF, 0xFF, 0x05, 0x05, 0xFF, 0x0D, 0xFF, 0x0D, 0xFF, 0xFF,
+    /*  496 */ 0x11, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x05, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01,
+    /*  512 */ 0x01, 0x0D, 0xFF, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0xFF, 0xFF,
+    /*  528 */ 0xFF, 0x01, 0xFF, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x01, 0x01, 0x01, 0xFF, 0xFF, 0xFF, 0xFF,
+    /*  544 */ 0xFF, 0xFF, 0x16, 0x16, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x01, 0x01, 0x01, 0xFF, 0x01, 0xFF,
+    /*  560 */ 0x01, 0xFF, 0x01, 0x01, 0x01, 0x01, 0x01, 0x16, 0x12, 0xFF, 0xFF, 0x12, 0x12, 0xFF, 0x01, 0x01,
+    /*  576 */ 0x01, 0x01, 0x01, 0x12, 0x12, 0x12, 0x01, 0xFF, 0x12, 0x12, 0x12, 0xFF, 0x12, 0x12, 0x06, 0xFF,
+    /*  592 */ 0x12, 0x06, 0xFF, 0x06, 0x12, 0xFF, 0xFF, 0x12, 0x12, 0x12, 0xFF, 0x12, 0x12, 0xFF, 0xFF, 0x12,
+    /*  608 */ 0x12, 0x13, 0xFF, 0x12, 0xFF, 0xFF, 0xFF, 0x12, 0x12, 0x13, 0x12, 0xFF, 0x12, 0xFF, 0xFF, 0x12,
+    /*  624 */ 0x12, 0xFF, 0x12, 0x12, 0x16, 0xFF, 0xFF, 0x12, 0xFF, 0xFF, 0x12, 0x12, 0x12, 0xFF, 0xFF, 0xFF,
+    /*  640 */ 0xFF, 0xFF, 0x12, 0x12, 0xFF, 0x12, 0xFF, 0xFF, 0x12, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    /*  656 */ 0x0D, 0x12, 0x12, 0xFF, 0x06, 0xFF, 0x12, 0xFF, 0xFF, 0xFF, 0xFF, 0x06, 0x06, 0x06, 0xFF, 0xFF,
+    /*  672 */ 0xFF, 0x12, 0x06, 0x12, 0x12, 0xFF, 0xFF, 0xFF, 0x12, 0x12, 0x12, 0x14, 0x12, 0x12, 0xFF, 0x12,
+    /*  688 */ 0xFF, 0x12, 0x12, 0xFF, 0x12, 0x12, 0x12, 0xFF, 0x13, 0x19, 0xFF, 0xFF, 0x06, 0x13, 0xFF, 0xFF,
+    /*  704 */ 0xFF, 0xFF, 0xFF, 0x06, 0x06, 0x13, 0x13, 0xFF, 0x13, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x13, 0x13,
+    /*  720 */ 0xFF, 0x1A, 0x1A, 0x1A, 0x1A, 0x1A, 0xFF, 0xFF, 0x13, 0x1A, 0x1A, 0x1A, 0xFF, 0x13, 0xFF, 0xFF,
+    /*  736 */ 0xFF, 0x13, 0xFF, 0xFF, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13,
+    /*  752 */ 0x13, 0x13, 0x13, 0x13, 0xFF, 0xFF, 0xFF, 0xFF, 0x1A, 0x1A, 0x14, 0xFF, 0xFF, 0xFF, 0xFF, 0x14,
+    /*  768 */ 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x17, 0xFF, 0x14, 0x14, 0xFF, 0x14, 0x13, 0x13, 0x1A, 0xFF, 0xFF,
+    /*  784 */ 0x14, 0x14, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x17, 0xFF, 0x14, 0xFF, 0xFF, 0xFF, 0xFF, 0x14,
+    /*  800 */ 0x13, 0xFF, 0xFF, 0x18, 0xFF, 0xFF, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0x14,
+    /*  816 */ 0x14, 0x14, 0x14, 0x14, 0x14, 0x14, 0xFF, 0xFF, 0xFF, 0x19, 0xFF, 0xFF, 0x19, 0x19, 0x19, 0x19,
+    /*  832 */ 0x19, 0xFF, 0xFF, 0xFF, 0x19, 0x19, 0x19, 0x0E, 0x0E, 0x0E, 0x1A, 0xFF, 0xFF, 0x14, 0x14, 0x0E,
+    /*  848 */ 0x0E, 0x13, 0xFF, 0xFF, 0xFF, 0xFF, 0x0E, 0x0E, 0x0E, 0x0E, 0xFF, 0xFF, 0xFF, 0x13, 0x0E, 0x0E,
+    /*  864 */ 0x0E, 0x17, 0x14, 0x19, 0x19, 0xFF, 0x0E, 0xFF, 0x0E, 0xFF, 0xFF, 0xFF, 0x18, 0xFF, 0x0E, 0x0E,
+    /*  880 */ 0x0E, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x0E, 0x19, 0x0E, 0xFF, 0x17, 0xFF, 0xFF, 0xFF, 0xFF,
+    /*  896 */ 0xFF, 0xFF, 0xFF, 0x17, 0xFF, 0x17, 0x18, 0xFF, 0x17, 0x17, 0x17, 0x17, 0x17, 0x0E, 0x18, 0xFF,
+    /*  912 */ 0x17, 0x17, 0x17, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, 0xFF, 0x18, 0x18, 0x18, 0xFF, 0x14,
+    /*  928 */ 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x17,
+    /*  944 */ 0x17, 0xFF, 0xFF, 0xFF, 0xFF, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0x18, 0x18, 0xFF, 0xFF, 0xFF, 0xFF,
+    /*  960 */ 0xFF, 0xFF, 0xFF, 0xFF, 0x17, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x18,
+    /*  976 */ 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    /*  992 */ 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    /* 1008 */ 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x17, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    /* 1024 */ 0xFF, 0x17, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x18,
+};
+
+#endif
@@ -31,6 +31,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define MATRIX_ROWS 8
 #define MATRIX_COLS 16
 
+/* converter marks modified rows */
+#define MATRIX_DIRTY_ROWS
+
 
 /* key combination for command */
 #define IS_COMMAND() ( \
@@ -100,6 +103,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define IBMPC_INT_VECT1   INT3_vect
 #endif
 
+// third and fourth interface: IBMPC_CLOCK_BIT2, IBMPC_DATA_BIT2 and IBMPC_INT_VECT2, and so on.
+// Clock of every interface requires INT pin on IBMPC_CLOCK_PORT.
+
 
 /* reset line */
 #define IBMPC_RST_PORT    PORTB
@@ -32,19 +32,26 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "mouse.h"
 
 
-// Converter
-IBMPCConverter converter0 = IBMPCConverter(IBMPC::interface0);
-#if defined(IBMPC_CLOCK_BIT1) && defined(IBMPC_DATA_BIT1)
-IBMPCConverter converter1 = IBMPCConverter(IBMPC::interface1);
+// Converter for each interface
+IBMPCConverter converters[IBMPC_INTERFACES] = {
+    IBMPCConverter(IBMPC::interface0),
+#if IBMPC_INTERFACES > 1
+    IBMPCConverter(IBMPC::interface1),
 #endif
+#if IBMPC_INTERFACES > 2
+    IBMPCConverter(IBMPC::interface2),
+#endif
+#if IBMPC_INTERFACES > 3
+    IBMPCConverter(IBMPC::interface3),
+#endif
+};
 
 
 void hook_early_init(void)
 {
-    converter0.init();
-#if defined(IBMPC_CLOCK_BIT1) && defined(IBMPC_DATA_BIT1)
-    converter1.init();
-#endif
+    for (uint8_t i = 0; i < IBMPC_INTERFACES; i++) {
+        converters[i].init();
+    }
 }
 
 void matrix_init(void)
@@ -54,30 +61,38 @@ void matrix_init(void)
     matrix_clear();
 }
 
+// keys held on any of interfaces
 matrix_row_t matrix_get_row(uint8_t row)
 {
-    return IBMPCConverter::matrix_get_row(row);
+    matrix_row_t r = 0;
+    for (uint8_t i = 0; i < IBMPC_INTERFACES; i++) {
+        r |= converters[i].matrix_get_row(row);
+    }
+    return r;
 }
 
 void matrix_clear(void)
 {
-    IBMPCConverter::matrix_clear();
+    for (uint8_t i = 0; i < IBMPC_INTERFACES; i++) {
+        converters[i].matrix_clear();
+    }
 }
 
 uint8_t matrix_scan(void)
 {
-    converter0.process_interface();
-#if defined(IBMPC_CLOCK_BIT1) && defined(IBMPC_DATA_BIT1)
-    converter1.process_interface();
+    for (uint8_t i = 0; i < IBMPC_INTERFACES; i++) {
+        converters[i].process_interface();
+#ifdef IBMPC_CAPTURE
+        converters[i].ibmpc.capture_task();
 #endif
+    }
 }
 
 void led_set(uint8_t usb_led)
 {
-    converter0.set_led(usb_led);
-#if defined(IBMPC_CLOCK_BIT1) && defined(IBMPC_DATA_BIT1)
-    converter1.set_led(usb_led);
-#endif
+    for (uint8_t i = 0; i < IBMPC_INTERFACES; i++) {
+        converters[i].set_led(usb_led);
+    }
 }
 
 extern const action_t actionmaps[][UNIMAP_ROWS][UNIMAP_COLS];
@@ -172,16 +187,25 @@ DONE:
     return id;
 }
 
-static void clear_stuck_keys(void)
+void IBMPCConverter::clear_stuck_keys(void)
 {
     matrix_clear();
+
+    // keys of other interfaces are still held, own keys are released through matrix
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        if (::matrix_get_row(row)) goto END;
+    }
     clear_keyboard();
+END:
     xprintf("\n[CLR] ");
 }
 
 
 uint8_t IBMPCConverter::process_interface(void)
 {
+    // nothing to do until ISR receives data or error
+    if (state == LOOP && !ibmpc.host_pending()) return 0;
+
     if (ibmpc.error) {
         xprintf("\n%u ERR:%02X ISR:%04X ", timer_read(), ibmpc.error, ibmpc.isr_debug);
 
@@ -496,6 +520,11 @@ MOUSE_DONE:
                 default:
                     break;
             }
+#ifdef IBMPC_CODESET_TABLE
+            // PC_XT, PC_AT and PC_TERMINAL are number of code set
+            codeset = ibmpc_cs_select(ibmpc_cs_variants, IBMPC_CS_VARIANTS, keyboard_kind, keyboard_id);
+            state_cs = 0;
+#endif
             state = LOOP;
             xprintf("L%u ", timer_read());
         case LOOP:
@@ -507,6 +536,13 @@ MOUSE_DONE:
                 }
 
                 switch (keyboard_kind) {
+#ifdef IBMPC_CODESET_TABLE
+                    case PC_XT:
+                    case PC_AT:
+                    case PC_TERMINAL:
+                        if (process_codeset(code) == -1) state = ERROR;
+                        break;
+#else
                     case PC_XT:
                         if (process_cs1(code) == -1) state = ERROR;
                         break;
@@ -516,6 +552,7 @@ MOUSE_DONE:
                     case PC_TERMINAL:
                         if (process_cs3(code) == -1) state = ERROR;
                         break;
+#endif
 #ifdef IBMPC_MOUSE_ENABLE
                     case PC_MOUSE: {
                         // Logitec Mouse Data:
@@ -653,6 +690,55 @@ MOUSE_DONE:
 }
 
 
+#ifdef IBMPC_CODESET_TABLE
+/*******************************************************************************
+ * Scan Code Set 1, 2 and 3 decoded with tables generated from codeset.txt
+ *
+ * See protocol/ibmpc_codeset.h. Translation of codes into matrix is same as
+ * process_cs1/2/3() below.
+ */
+int8_t IBMPCConverter::process_codeset(uint8_t code)
+{
+    if (codeset == 0xFF) return 0;
+
+    uint8_t s = state_cs;
+    uint8_t key = 0;
+    uint8_t ev = ibmpc_cs_step(&ibmpc_cs_states[codeset], ibmpc_cs_entries, ibmpc_cs_rows,
+                               IBMPC_CS_ENTRIES, &state_cs, code, &key);
+    if (ev & IBMPC_CS_WARN) {
+        xprintf("!CS%u_%02X_%02X!\n", keyboard_kind, s, code);
+    }
+    switch (ev & ~IBMPC_CS_WARN) {
+        case IBMPC_CS_MAKE:
+            matrix_make(key);
+            break;
+        case IBMPC_CS_BREAK:
+            matrix_break(key);
+            break;
+        case IBMPC_CS_OVERRUN:
+            clear_stuck_keys();
+            break;
+        case IBMPC_CS_ERROR:
+            matrix_clear();
+            xprintf("!CS%u_%02X_%02X!\n", keyboard_kind, s, code);
+            return -1;
+        case IBMPC_CS_RESET:
+            xprintf("!CS%u_RESET!\n", keyboard_kind);
+            return -1;
+        case IBMPC_CS_UNKNOWN:
+            xprintf("!CS%u_%02X_%02X!\n", keyboard_kind, s, code);
+            break;
+        case IBMPC_CS_CLEAR:
+            matrix_clear();
+            break;
+        default:
+            break;
+    }
+    return 0;
+}
+#else
+
+
 /*******************************************************************************
  * XT: Scan Code Set 1
  *
@@ -1401,6 +1487,7 @@ int8_t IBMPCConverter::process_cs3(uint8_t code)
     }
     return 0;
 }
+#endif
 
 /*
  * IBM PC Keyboard Protocol Resources:
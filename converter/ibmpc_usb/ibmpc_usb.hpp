@@ -4,6 +4,9 @@
 #include <avr/pgmspace.h>
 #include "matrix.h"
 #include "unimap_trans.h"
+#ifdef IBMPC_CODESET_TABLE
+#include "codeset.h"
+#endif
 
 
 
@@ -28,10 +31,14 @@ typedef enum { NONE, PC_XT, PC_AT, PC_TERMINAL, PC_MOUSE } keyboard_kind_t;
 #define COL(code)      (code&0x0F)
 
 
+/*
+ * Each interface has its own converter and matrix. A key is on while any of
+ * interfaces holds it, matrix_get_row() of ibmpc_usb.cpp merges rows of all
+ * converters, and release on one keyboard doesn't cancel the key held on
+ * other one. Error and reset of interface clear only keys of its own.
+ */
 class IBMPCConverter {
     public:
-    static matrix_row_t matrix[MATRIX_ROWS];
-
     IBMPC &ibmpc;
 
     IBMPCConverter(IBMPC &_ibmpc) : ibmpc(_ibmpc), keyboard_id(0), keyboard_kind(NONE), current_protocol(0) {
@@ -42,6 +49,9 @@ class IBMPCConverter {
         keyboard_id = 0x0000;
         keyboard_kind = NONE;
         current_protocol = 0;
+#ifdef IBMPC_CODESET_TABLE
+        state_cs = 0;
+#endif
         matrix_clear();
         ibmpc.host_init();
     }
@@ -50,16 +60,22 @@ class IBMPCConverter {
 
     void set_led(uint8_t usb_led);
 
-    static inline void matrix_clear(void) {
-        for (uint8_t i=0; i < MATRIX_ROWS; i++) matrix[i] = 0x00;
+    inline void matrix_clear(void) {
+        for (uint8_t i=0; i < MATRIX_ROWS; i++) {
+            if (matrix[i]) matrix_set_dirty(i);
+            matrix[i] = 0x00;
+        }
     }
 
-    static inline matrix_row_t matrix_get_row(uint8_t row) {
+    inline matrix_row_t matrix_get_row(uint8_t row) {
         return matrix[row];
     }
 
 
     private:
+    // keys held on this interface
+    matrix_row_t matrix[MATRIX_ROWS];
+
     uint16_t keyboard_id = 0x0000;
     keyboard_kind_t keyboard_kind = NONE;
     uint8_t current_protocol = 0;
@@ -82,6 +98,13 @@ class IBMPCConverter {
         ERROR_PARITY_AA,
     } state = INIT;
 
+#ifdef IBMPC_CODESET_TABLE
+    // states of code set and keyboard ID in ibmpc_cs_states
+    uint8_t codeset = 0;
+    uint8_t state_cs = 0;
+
+    int8_t process_codeset(uint8_t code);
+#else
     enum CS1_state {
         CS1_INIT,
         CS1_E0,
@@ -130,7 +153,9 @@ class IBMPCConverter {
     uint8_t translate_5576_cs2_e0(uint8_t code);
     uint8_t translate_5576_cs3(uint8_t code);
     uint8_t translate_televideo_dec_cs3(uint8_t code);
+#endif
 
+    void clear_stuck_keys(void);
     int16_t read_wait(uint16_t wait_ms);
     uint16_t read_keyboard_id(void);
 
@@ -138,15 +163,17 @@ class IBMPCConverter {
     inline void matrix_make(uint8_t code) {
         uint8_t u = to_unimap(code);
         if (u > 0x7F) return;
-        if (!matrix_is_on(ROW(u), COL(u))) {
+        if (!(matrix[ROW(u)] & (1<<COL(u)))) {
             matrix[ROW(u)] |= 1<<COL(u);
+            matrix_set_dirty(ROW(u));
         }
     }
     inline void matrix_break(uint8_t code) {
         uint8_t u = to_unimap(code);
         if (u > 0x7F) return;
-        if (matrix_is_on(ROW(u), COL(u))) {
+        if (matrix[ROW(u)] & (1<<COL(u))) {
             matrix[ROW(u)] &= ~(1<<COL(u));
+            matrix_set_dirty(ROW(u));
         }
     }
     uint8_t to_unimap(uint8_t code) {
@@ -183,6 +210,4 @@ class IBMPCConverter {
 #endif
 };
 
-matrix_row_t IBMPCConverter::matrix[MATRIX_ROWS];
-
 #endif
@@ -17,7 +17,6 @@ Copyright 2024 Jun Wako <wakojun@gmail.com>
 #include "timer.h"
 #include "wait.h"
 #include "mouse.h"
-#include "ringbuf16.h"
 
 
 //debug
@@ -45,16 +44,8 @@ pin_t psw_pin = { &PORTD, 4 };
 //
 // keyboard uart
 //
-static uint16_t _rb[4];
-static ringbuf_t _rbuf = {
-    .buffer = _rb,
-    .size_mask = 3
-};
-static uint16_t _sb[4];
-static ringbuf_t _sbuf = {
-    .buffer = _sb,
-    .size_mask = 3
-};
+static suart_buf_t _rbuf;
+static suart_buf_t _sbuf;
 static suart_t next_suart = {
     .recv_pin = { &PORTD, 0 },
     .send_pin = { &PORTD, 1 },
@@ -127,7 +118,7 @@ ISR(TIMER1_COMPB_vect)
         if (PIN_STATE(_suart.recv_pin)) {
             // no event when xbit is 1 and data is 0
             //if (!xbit) {
-                ringbuf_put(_suart.rbuf, (xbit << 8) | data);
+                suart_buf_put(_suart.rbuf, (xbit << 8) | data);
             //}
         }
 
@@ -151,13 +142,12 @@ ISR(TIMER1_COMPA_vect)
 {
     suart_t *_suart = &next_suart;
     static uint8_t bit = 0;
-    static int16_t data = 0;
+    static uint16_t data = 0;
 
     switch (bit) {
     case 0:
         // start bit
-        data = ringbuf_get(_suart->sbuf);
-        if (data == -1) return;
+        if (!suart_buf_get(_suart->sbuf, &data)) return;
         NEXT_DEBUG_PIN_TOGGLE();
         ASSERT0(_suart);
         bit++;
@@ -4,7 +4,7 @@ Copyright 2024 Jun Wako <wakojun@gmail.com>
 #ifndef SOFTWARE_UART_H
 #define SOFTWARE_UART_H
 #include <util/delay.h>
-#include "ringbuf16.h"
+#include "spsc_ring.h"
 
 
 // timer tick per bit
@@ -56,6 +56,12 @@ enum logic {
     LOGIC_NEGATIVE = 1
 };
 
+// data buffer between ISR and main loop
+#ifndef SUART_BUF_SIZE
+#define SUART_BUF_SIZE  4
+#endif
+SPSC_RING_DEFINE(suart_buf, uint16_t, SUART_BUF_SIZE)
+
 typedef struct pin {
     volatile uint8_t *port;
     uint8_t bit;
@@ -64,8 +70,8 @@ typedef struct pin {
 typedef struct {
     pin_t recv_pin;
     pin_t send_pin;
-    ringbuf_t *rbuf;
-    ringbuf_t *sbuf;
+    suart_buf_t *rbuf;
+    suart_buf_t *sbuf;
 /*
     uint8_t rbit;
     uint8_t sbit;
@@ -97,18 +103,14 @@ void suart_init(const suart_t *s)
 
 int16_t suart_receive(const suart_t *s)
 {
-    int16_t d;
-    cli();
-    d = ringbuf_get(s->rbuf);
-    sei();
+    uint16_t d;
+    if (!suart_buf_get(s->rbuf, &d)) return -1;
     return d;
 }
 
 void suart_send(const suart_t *s, uint16_t data)
 {
-    cli();
-    ringbuf_put(s->sbuf, data);
-    sei();
+    suart_buf_put(s->sbuf, data);
 }
 
 
@@ -120,8 +122,7 @@ void suart_receive_in_isr(suart_t *_suart) {
 void suart_send_in_isr(suart_t *_suart) {
     switch (_suart->sbit) {
     case 0: /* start bit */
-        if (ringbuf_is_empty(_suart->sbuf)) return;
-        _suart->sdata = ringbuf_get(_suart->sbuf);
+        if (!suart_buf_get(_suart->sbuf, &_suart->sdata)) return;
         ASSERT0(_suart);
         _suart->sbit++;
         break;
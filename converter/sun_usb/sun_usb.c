@@ -44,16 +44,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 //
 // keyboard uart
 //
-static uint8_t kb_rb[16];
-static ringbuf_t kb_rbuf = {
-    .buffer = kb_rb,
-    .size_mask = 15
-};
-static uint8_t kb_sb[16];
-static ringbuf_t kb_sbuf = {
-    .buffer = kb_sb,
-    .size_mask = 15
-};
+static suart_buf_t kb_rbuf;
+static suart_buf_t kb_sbuf;
 static suart_t kb_suart = {
     .recv_pin = { &PORTD, 2 },
     .send_pin = { &PORTD, 3 },
@@ -108,7 +100,7 @@ ISR(TIMER1_COMPB_vect)
     case 9:
         // stop bit
         if (!PIN_STATE(_suart.recv_pin)) {
-            ringbuf_put(_suart.rbuf, data);
+            suart_buf_put(_suart.rbuf, data);
         }
 
         TIMSK1 &= ~(1 << OCIE1B);   // disable TIMER1_COMPB interrupt
@@ -131,8 +123,7 @@ ISR(TIMER1_COMPA_vect)
     switch (bit) {
     case 0:
         // start bit
-        if (ringbuf_is_empty(_suart->sbuf)) return;
-        data = ringbuf_get(_suart->sbuf);
+        if (!suart_buf_get(_suart->sbuf, &data)) return;
         ASSERT0(_suart);
         bit++;
         break;
@@ -164,11 +155,7 @@ ISR(TIMER1_COMPA_vect)
 //
 // mouse uart
 //
-static uint8_t ms_buf[16];
-static ringbuf_t ms_rbuf = {
-    .buffer = ms_buf,
-    .size_mask = 15
-};
+static suart_buf_t ms_rbuf;
 static suart_t ms_suart = {
     .recv_pin = { &PORTD, 4 },
     .send_pin = {},
@@ -217,7 +204,7 @@ ISR(TIMER1_COMPC_vect)
     case 9:
         // stop bit
         if (!PIN_STATE(_suart.recv_pin)) {
-            ringbuf_put(_suart.rbuf, data);
+            suart_buf_put(_suart.rbuf, data);
         }
 
         TIMSK1 &= ~(1 << OCIE1C);   // disable TIMER1_COMPC interrupt
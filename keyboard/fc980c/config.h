@@ -31,6 +31,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define MATRIX_ROWS 8
 #define MATRIX_COLS 16
 
+/* us for KEY_STATE to return to idle after KEY_UNABLE in pipelined scan
+ * (MATRIX_SCAN_PIPELINE_ENABLE), see common/avr/matrix_pipeline.c */
+#define MATRIX_SCAN_RECOVERY    30
+
 
 /* key combination for command */
 #define IS_COMMAND() (keyboard_report->mods == (MOD_BIT(KC_LSHIFT) | MOD_BIT(KC_RSHIFT))) 
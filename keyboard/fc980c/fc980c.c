@@ -28,8 +28,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "matrix.h"
 #include "led.h"
 #include "fc980c.h"
+#include "avr/matrix_pipeline.h"
 
 
+#ifndef MATRIX_SCAN_PIPELINE
 static uint32_t matrix_last_modified = 0;
 
 // matrix state buffer(1:on, 0:off)
@@ -37,6 +39,16 @@ static matrix_row_t *matrix;
 static matrix_row_t *matrix_prev;
 static matrix_row_t _matrix0[MATRIX_ROWS];
 static matrix_row_t _matrix1[MATRIX_ROWS];
+#else
+// controller access for common/avr/matrix_pipeline.c
+void matrix_pipeline_set_col(uint8_t col) { SET_COL(col); }
+void matrix_pipeline_set_row(uint8_t row) { SET_ROW(row); }
+void matrix_pipeline_key_enable(void) { KEY_ENABLE(); }
+void matrix_pipeline_key_unable(void) { KEY_UNABLE(); }
+bool matrix_pipeline_key_state(void) { return KEY_STATE(); }
+void matrix_pipeline_hys_on(void) { KEY_HYS_ON(); }
+void matrix_pipeline_hys_off(void) { KEY_HYS_OFF(); }
+#endif
 
 
 void matrix_init(void)
@@ -53,13 +65,16 @@ void matrix_init(void)
     DDRB  |= (1<<4) | (1<<5) | (1<<6);
     PORTB &= ~((1<<4) | (1<<5) | (1<<6));
 
+#ifndef MATRIX_SCAN_PIPELINE
     // initialize matrix state: all keys off
     for (uint8_t i=0; i < MATRIX_ROWS; i++) _matrix0[i] = 0x00;
     for (uint8_t i=0; i < MATRIX_ROWS; i++) _matrix1[i] = 0x00;
     matrix = _matrix0;
     matrix_prev = _matrix1;
+#endif
 }
 
+#ifndef MATRIX_SCAN_PIPELINE
 uint8_t matrix_scan(void)
 {
     matrix_row_t *tmp;
@@ -125,6 +140,7 @@ matrix_row_t matrix_get_row(uint8_t row)
 {
     return matrix[row];
 }
+#endif
 
 void led_set(uint8_t usb_led)
 {
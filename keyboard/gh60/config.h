@@ -34,8 +34,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 /* define if matrix has ghost */
 //#define MATRIX_HAS_GHOST
 
+/* columns on PCINT0-7 to wake from sleep with MATRIX_WAKE_ENABLE: B0 B1 B3 B4 B5 B6 B7 */
+#define MATRIX_WAKE_PCMSK   0b11111011
+
 /* Set 0 if debouncing isn't needed */
 #define DEBOUNCE    5
+/* Report change at once and ignore chatter after it. see common/debounce.c */
+//#define DEBOUNCE_EAGER_KEY
 
 /* Mechanical locking support. Use KC_LCAP, KC_LNUM or KC_LSCR instead in keymap */
 #define LOCKING_SUPPORT_ENABLE
@@ -143,3 +143,18 @@ const action_t PROGMEM fn_actions[] = {
     [8] = ACTION_DEFAULT_LAYER_SET(3),  // set workman layout
     [9] = ACTION_MODS_TAP_KEY(MOD_RSFT, KC_GRV),
 };
+
+#ifdef TAPPING_CONFIG_ENABLE
+#include "action_tapping.h"
+
+/*
+ * Tapping config of key, see trace/tapping_config.txt of tool/host
+ */
+const tapping_config_t PROGMEM tapping_config[] = {
+    /* row, col, term(ms), quick(ms), flags */
+    TAPPING_CONFIG(2, 10, 120, 120, 0),             // Fn2(;) short term
+    TAPPING_CONFIG(3, 11, 200, 400, 0),             // Fn1(/) repeats on quick tap
+    TAPPING_CONFIG(3, 13, 200, 0, TAPPING_RETRO),   // Fn9(RShift) grave on retro tap
+    TAPPING_CONFIG_END
+};
+#endif
@@ -0,0 +1,59 @@
+#include "keymap_common.h"
+
+/*
+ * Stacked layers for benchmark of layer resolution
+ *
+ * Layer 1-12 are transparent except F1-F12 on number row and 13-15 are
+ * all transparent. Turn them on with -l option of host replay:
+ *
+ *     $ make -f Makefile.host KEYMAP=stack
+ *     $ obj_gh60_host/gh60_host -l FFFF -b 1000 trace.txt
+ */
+#define KEYMAP_TRNS(K01, K02, K03, K04, K05, K06, K07, K08, K09, K0A, K0B, K0C) \
+    KEYMAP_ANSI( \
+        TRNS,K01, K02, K03, K04, K05, K06, K07, K08, K09, K0A, K0B, K0C, TRNS, \
+        TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS, \
+        TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,     TRNS, \
+        TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,          TRNS, \
+        TRNS,TRNS,TRNS,          TRNS,                    TRNS,TRNS,TRNS,TRNS)
+
+const uint8_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    /* 0: qwerty */
+    KEYMAP_ANSI(
+        ESC, 1,   2,   3,   4,   5,   6,   7,   8,   9,   0,   MINS,EQL, BSPC, \
+        TAB, Q,   W,   E,   R,   T,   Y,   U,   I,   O,   P,   LBRC,RBRC,BSLS, \
+        CAPS,A,   S,   D,   F,   G,   H,   J,   K,   L,   SCLN,QUOT,     ENT,  \
+        LSFT,Z,   X,   C,   V,   B,   N,   M,   COMM,DOT, SLSH,          RSFT, \
+        LCTL,LGUI,LALT,          SPC,                     RALT,RGUI,APP, RCTL),
+    /* 1 */
+    KEYMAP_TRNS(F1,  TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS),
+    /* 2 */
+    KEYMAP_TRNS(TRNS,F2,  TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS),
+    /* 3 */
+    KEYMAP_TRNS(TRNS,TRNS,F3,  TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS),
+    /* 4 */
+    KEYMAP_TRNS(TRNS,TRNS,TRNS,F4,  TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS),
+    /* 5 */
+    KEYMAP_TRNS(TRNS,TRNS,TRNS,TRNS,F5,  TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS),
+    /* 6 */
+    KEYMAP_TRNS(TRNS,TRNS,TRNS,TRNS,TRNS,F6,  TRNS,TRNS,TRNS,TRNS,TRNS,TRNS),
+    /* 7 */
+    KEYMAP_TRNS(TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,F7,  TRNS,TRNS,TRNS,TRNS,TRNS),
+    /* 8 */
+    KEYMAP_TRNS(TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,F8,  TRNS,TRNS,TRNS,TRNS),
+    /* 9 */
+    KEYMAP_TRNS(TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,F9,  TRNS,TRNS,TRNS),
+    /* 10 */
+    KEYMAP_TRNS(TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,F10, TRNS,TRNS),
+    /* 11 */
+    KEYMAP_TRNS(TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,F11, TRNS),
+    /* 12 */
+    KEYMAP_TRNS(TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,F12),
+    /* 13 */
+    KEYMAP_TRNS(TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS),
+    /* 14 */
+    KEYMAP_TRNS(TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS),
+    /* 15 */
+    KEYMAP_TRNS(TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS,TRNS),
+};
+const action_t PROGMEM fn_actions[] = {};
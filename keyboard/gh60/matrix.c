@@ -27,18 +27,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "util.h"
 #include "timer.h"
 #include "matrix.h"
-
-
-#ifndef DEBOUNCE
-#   define DEBOUNCE	5
+#ifdef MATRIX_WAKE_ENABLE
+#include "matrix_wake.h"
 #endif
-static bool debouncing = false;
-static uint16_t debouncing_time = 0;
 
 
 /* matrix state(1:on, 0:off) */
 static matrix_row_t matrix[MATRIX_ROWS];
-static matrix_row_t matrix_debouncing[MATRIX_ROWS];
+static matrix_row_t matrix_raw[MATRIX_ROWS];
 
 static matrix_row_t read_cols(void);
 static void init_cols(void);
@@ -55,7 +51,7 @@ void matrix_init(void)
     // initialize matrix state: all keys off
     for (uint8_t i=0; i < MATRIX_ROWS; i++) {
         matrix[i] = 0;
-        matrix_debouncing[i] = 0;
+        matrix_raw[i] = 0;
     }
 }
 
@@ -64,24 +60,11 @@ uint8_t matrix_scan(void)
     for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
         select_row(i);
         _delay_us(1);  // delay for settling
-        matrix_row_t cols = read_cols();
-        if (matrix_debouncing[i] != cols) {
-            if (debouncing) {
-                dprintf("bounce: %d %d@%02X\n", timer_elapsed(debouncing_time), i, matrix_debouncing[i]^cols);
-            }
-            matrix_debouncing[i] = cols;
-            debouncing = true;
-            debouncing_time = timer_read();
-        }
+        matrix_raw[i] = read_cols();
         unselect_rows();
     }
 
-    if (debouncing && timer_elapsed(debouncing_time) >= DEBOUNCE) {
-        for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
-            matrix[i] = matrix_debouncing[i];
-        }
-        debouncing = false;
-    }
+    matrix_debounce(matrix, matrix_raw);
 
     return 1;
 }
@@ -167,3 +150,29 @@ static void select_row(uint8_t row)
             break;
     }
 }
+
+#ifdef MATRIX_WAKE_ENABLE
+/* all rows are selected while waiting for key */
+static void select_all_rows(void)
+{
+    DDRD  |=  0b00101111;
+    PORTD &= ~0b00101111;
+}
+
+bool matrix_wake_key(void)
+{
+    return read_cols();
+}
+
+void matrix_power_down(void)
+{
+    select_all_rows();
+    matrix_wake_start();
+}
+
+void matrix_power_up(void)
+{
+    matrix_wake_stop();
+    unselect_rows();
+}
+#endif
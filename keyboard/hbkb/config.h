@@ -36,6 +36,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 /* Set 0 if need no debouncing */
 #define DEBOUNCE    5
+/* Report change at once and ignore chatter after it. see common/debounce.c */
+//#define DEBOUNCE_EAGER_KEY
 
 /* legacy keymap support */
 #define USE_LEGACY_KEYMAP
@@ -52,6 +52,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 /* power control of key switch board */
 #define HHKB_POWER_SAVING
+/* scan every 10ms while idle, see matrix.c */
+//#define MATRIX_IDLE_SCAN        10
+/* print scan duty and delay of key down every 10s */
+//#define MATRIX_SCAN_REPORT      10000
 
 /*
  * Hardware Serial(UART)
@@ -42,6 +42,38 @@ static matrix_row_t *matrix_prev;
 static matrix_row_t _matrix0[MATRIX_ROWS];
 static matrix_row_t _matrix1[MATRIX_ROWS];
 
+#ifdef MATRIX_IDLE_SCAN
+/*
+ * Low duty scan while idle
+ *
+ * Scan of whole matrix takes 6ms or so and main loop does little else. When
+ * no key is down and matrix has not been modified for MATRIX_IDLE_TIMEOUT ms
+ * it is scanned only every MATRIX_IDLE_SCAN ms, MCU can sleep in between
+ * with IDLE_SLEEP_ENABLE. Key switch power stays on since powering up takes
+ * 5ms. Full rate resumes on first key down, which is MATRIX_IDLE_SCAN ms late
+ * at most.
+ */
+#ifndef MATRIX_IDLE_TIMEOUT
+#define MATRIX_IDLE_TIMEOUT     1000
+#endif
+static uint32_t matrix_last_scan = 0;
+#endif
+
+#ifdef MATRIX_SCAN_REPORT
+/*
+ * Prints every MATRIX_SCAN_REPORT ms
+ *      duty:   time in scan per mille, compare with current draw
+ *      delay:  max and average ms from previous scan to scan finding a key down
+ */
+static uint32_t report_time = 0;
+static uint32_t report_busy = 0;
+static uint32_t report_prev = 0;
+static uint32_t report_delay = 0;
+static uint16_t report_delay_max = 0;
+static uint16_t report_scans = 0;
+static uint16_t report_presses = 0;
+#endif
+
 
 void matrix_init(void)
 {
@@ -59,10 +91,59 @@ void matrix_init(void)
     matrix_prev = _matrix1;
 }
 
+#ifdef MATRIX_IDLE_SCAN
+static bool matrix_idle(void)
+{
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        if (matrix[row]) return false;
+    }
+    return timer_elapsed32(matrix_last_modified) > MATRIX_IDLE_TIMEOUT;
+}
+#endif
+
+#ifdef MATRIX_SCAN_REPORT
+static void matrix_report(uint32_t start)
+{
+    uint32_t now = timer_read32();
+    report_busy += now - start;
+    report_scans++;
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        if (matrix[row] & ~matrix_prev[row]) {
+            uint16_t delay = now - report_prev;
+            report_delay += delay;
+            if (delay > report_delay_max) report_delay_max = delay;
+            report_presses++;
+            break;
+        }
+    }
+    report_prev = start;
+
+    uint32_t elapsed = now - report_time;
+    if (elapsed < MATRIX_SCAN_REPORT) return;
+    xprintf("scan: duty:%u/1000 scans:%u presses:%u delay max:%u avg:%u\n",
+            (uint16_t)(report_busy * 1000 / elapsed), report_scans, report_presses,
+            report_delay_max, report_presses ? (uint16_t)(report_delay / report_presses) : 0);
+    report_time = now;
+    report_busy = 0;
+    report_delay = 0;
+    report_delay_max = 0;
+    report_scans = 0;
+    report_presses = 0;
+}
+#endif
+
 uint8_t matrix_scan(void)
 {
     uint8_t *tmp;
 
+#ifdef MATRIX_IDLE_SCAN
+    if (matrix_idle() && timer_elapsed32(matrix_last_scan) < MATRIX_IDLE_SCAN) return 0;
+    matrix_last_scan = timer_read32();
+#endif
+#ifdef MATRIX_SCAN_REPORT
+    uint32_t start = timer_read32();
+#endif
+
     tmp = matrix_prev;
     matrix_prev = matrix;
     matrix = tmp;
@@ -130,6 +211,9 @@ uint8_t matrix_scan(void)
         }
         if (matrix[row] ^ matrix_prev[row]) matrix_last_modified = timer_read32();
     }
+#ifdef MATRIX_SCAN_REPORT
+    matrix_report(start);
+#endif
     // power off
     if (KEY_POWER_STATE() &&
             (USB_DeviceState == DEVICE_STATE_Suspended ||
@@ -14,6 +14,9 @@
 #include "wait.h"
 #include "suart.h"
 #include "suspend.h"
+#ifdef IDLE_SLEEP_ENABLE
+#include "idle_sleep.h"
+#endif
 
 static int8_t sendchar_func(uint8_t c)
 {
@@ -96,10 +99,22 @@ int main(void)
 
         keyboard_task();
 
+#ifdef REPORT_QUEUE_SIZE
+        lufa_report_queue_task();
+#endif
+
+#ifdef CONSOLE_ENABLE
+        lufa_console_task();
+#endif
+
 #if !defined(INTERRUPT_CONTROL_ENDPOINT)
         USB_USBTask();
 #endif
 
         rn42_task();
+
+#ifdef IDLE_SLEEP_ENABLE
+        idle_sleep_task();
+#endif
     }
 }
@@ -6,10 +6,6 @@
 #include "matrix.h"
 
 
-#ifndef DEBOUNCE
-#define DEBOUNCE    5
-#endif
-
 /*
  * Infinity Pinusage:
  * Column pins are input with internal pull-down. Row pins are output and strobe with high.
@@ -23,9 +19,7 @@ static gpio_t row[MATRIX_ROWS];
 
 /* matrix state(1:on, 0:off) */
 static matrix_row_t matrix[MATRIX_ROWS];
-static matrix_row_t matrix_debouncing[MATRIX_ROWS];
-static bool debouncing = false;
-static uint16_t debouncing_time = 0;
+static matrix_row_t matrix_raw[MATRIX_ROWS];
 
 
 void matrix_init(void)
@@ -77,31 +71,10 @@ uint8_t matrix_scan(void)
             }
         }
         gpio_write(&row[i], 0);
-
-        if (matrix_debouncing[i] != r) {
-            matrix_debouncing[i] = r;
-            debouncing = true;
-            debouncing_time = timer_read();
-        }
+        matrix_raw[i] = r;
     }
 
-    if (debouncing && timer_elapsed(debouncing_time) > DEBOUNCE) {
-        for (int i = 0; i < MATRIX_ROWS; i++) {
-            matrix[i] = matrix_debouncing[i];
-        }
-        debouncing = false;
-    }
-/*
-    if (debouncing) {
-        if (--debouncing) {
-            return 0;
-        } else {
-            for (int i = 0; i < MATRIX_ROWS; i++) {
-                matrix[i] = matrix_debouncing[i];
-            }
-        }
-    }
-*/
+    matrix_debounce(matrix, matrix_raw);
     return 1;
 }
 
@@ -2,6 +2,7 @@ COMMON_DIR = common
 SRC +=	$(COMMON_DIR)/host.c \
 	$(COMMON_DIR)/keyboard.c \
 	$(COMMON_DIR)/matrix.c \
+	$(COMMON_DIR)/debounce.c \
 	$(COMMON_DIR)/action.c \
 	$(COMMON_DIR)/action_tapping.c \
 	$(COMMON_DIR)/action_macro.c \
@@ -78,6 +79,30 @@ ifeq (yes,$(strip $(COMMAND_ENABLE)))
     OPT_DEFS += -DCOMMAND_ENABLE
 endif
 
+ifeq (yes,$(strip $(LATENCY_TRACE_ENABLE)))
+    SRC += $(COMMON_DIR)/latency_trace.c
+    OPT_DEFS += -DLATENCY_TRACE_ENABLE
+endif
+
+ifdef KEYMAP_COMPILED
+    SRC += $(COMMON_DIR)/keymap_compiled.c
+    OPT_DEFS += -DKEYMAP_COMPILED_ENABLE
+    OPT_DEFS += -DKEYMAP_COMPILED=\"$(abspath $(KEYMAP_COMPILED))\"
+endif
+
+ifeq (yes,$(strip $(TLOG_ENABLE)))
+    SRC += $(COMMON_DIR)/tlog.c
+    OPT_DEFS += -DTLOG_ENABLE
+endif
+
+ifeq (yes,$(strip $(LAYER_CACHE_ENABLE)))
+    OPT_DEFS += -DLAYER_CACHE_ENABLE
+endif
+
+ifeq (yes,$(strip $(REPORT_INDEX_ENABLE)))
+    OPT_DEFS += -DREPORT_INDEX_ENABLE
+endif
+
 ifeq (yes,$(strip $(NKRO_ENABLE)))
     OPT_DEFS += -DNKRO_ENABLE
 endif
@@ -100,6 +125,21 @@ ifeq (yes,$(strip $(SLEEP_LED_ENABLE)))
     OPT_DEFS += -DNO_SUSPEND_POWER_DOWN
 endif
 
+ifeq (yes,$(strip $(IDLE_SLEEP_ENABLE)))
+    SRC += $(COMMON_DIR)/avr/idle_sleep.c
+    OPT_DEFS += -DIDLE_SLEEP_ENABLE
+endif
+
+ifeq (yes,$(strip $(MATRIX_WAKE_ENABLE)))
+    SRC += $(COMMON_DIR)/avr/matrix_wake.c
+    OPT_DEFS += -DMATRIX_WAKE_ENABLE
+endif
+
+ifeq (yes,$(strip $(MATRIX_SCAN_PIPELINE_ENABLE)))
+    SRC += $(COMMON_DIR)/avr/matrix_pipeline.c
+    OPT_DEFS += -DMATRIX_SCAN_PIPELINE
+endif
+
 ifeq (yes,$(strip $(BACKLIGHT_ENABLE)))
     SRC += $(COMMON_DIR)/backlight.c
     OPT_DEFS += -DBACKLIGHT_ENABLE
@@ -29,6 +29,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "hook.h"
 #include "wait.h"
 #include "bootloader.h"
+#include "latency_trace.h"
 
 #ifdef DEBUG_ACTION
 #include "debug.h"
@@ -39,6 +40,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 void action_exec(keyevent_t event)
 {
+    LATENCY_TRACE(LATENCY_TRACE_ACTION_EXEC);
     if (!IS_NOEVENT(event)) {
         dprint("\n---- action_exec: start -----\n");
         dprint("EVENT: "); debug_event(event); dprintln();
@@ -2,8 +2,12 @@
 #include "keyboard.h"
 #include "action.h"
 #include "util.h"
+#include "matrix.h"
 #include "action_layer.h"
 #include "hook.h"
+#ifdef KEYMAP_COMPILED_ENABLE
+#include "keymap_compiled.h"
+#endif
 
 #ifdef DEBUG_ACTION
 #include "debug.h"
@@ -12,6 +16,34 @@
 #endif
 
 
+/* nothing to resolve without layer switching */
+#if defined(LAYER_CACHE_ENABLE) && defined(NO_ACTION_LAYER)
+#   undef LAYER_CACHE_ENABLE
+#endif
+
+#ifdef LAYER_CACHE_ENABLE
+/*
+ * Layer cache
+ *
+ * Layer resolved for each key with current layer state. Entry is filled on
+ * first press of the key and all entries are dropped when layer state is
+ * changed. Keymap should not return different action for the same layer
+ * and key at run time.
+ */
+static uint8_t layer_cache[MATRIX_ROWS][MATRIX_COLS];
+static matrix_row_t layer_cache_valid[MATRIX_ROWS];
+
+static void layer_cache_clear(void)
+{
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        layer_cache_valid[i] = 0;
+    }
+}
+#else
+#define layer_cache_clear()     ((void)0)
+#endif
+
+
 /* 
  * Default Layer State
  */
@@ -22,6 +54,7 @@ static void default_layer_state_set(uint32_t state)
     debug("default_layer_state: ");
     default_layer_debug(); debug(" to ");
     default_layer_state = state;
+    layer_cache_clear();
     hook_default_layer_change(default_layer_state);
     default_layer_debug(); debug("\n");
 #ifdef NO_TRACK_KEY_PRESS
@@ -66,6 +99,7 @@ static void layer_state_set(uint32_t state)
     dprint("layer_state: ");
     layer_debug(); dprint(" to ");
     layer_state = state;
+    layer_cache_clear();
     hook_layer_change(layer_state);
     layer_debug(); dprintln();
 #ifdef NO_TRACK_KEY_PRESS
@@ -119,23 +153,44 @@ void layer_debug(void)
 
 
 
+#ifdef KEYMAP_COMPILED_ENABLE
+#define ACTION_FOR_KEY(layer, key)  keymap_compiled_action(layer, key)
+#else
+#define ACTION_FOR_KEY(layer, key)  action_for_key(layer, key)
+#endif
+
 /* return layer effective for key at this time */
 static uint8_t current_layer_for_key(keypos_t key)
 {
 #ifndef NO_ACTION_LAYER
-    action_t action = ACTION_TRANSPARENT;
+#ifdef LAYER_CACHE_ENABLE
+    if (layer_cache_valid[key.row] & ((matrix_row_t)1<<key.col)) {
+        return layer_cache[key.row][key.col];
+    }
+#endif
     uint32_t layers = layer_state | default_layer_state;
+#ifdef KEYMAP_COMPILED_ENABLE
+    uint8_t layer = keymap_compiled_layer(layers, key);
+#else
+    action_t action = ACTION_TRANSPARENT;
+    /* fall back to layer 0 */
+    uint8_t layer = 0;
     /* check top layer first */
     for (int8_t i = 31; i >= 0; i--) {
         if (layers & (1UL<<i)) {
             action = action_for_key(i, key);
             if (action.code != (action_t)ACTION_TRANSPARENT.code) {
-                return i;
+                layer = i;
+                break;
             }
         }
     }
-    /* fall back to layer 0 */
-    return 0;
+#endif
+#ifdef LAYER_CACHE_ENABLE
+    layer_cache[key.row][key.col] = layer;
+    layer_cache_valid[key.row] |= ((matrix_row_t)1<<key.col);
+#endif
+    return layer;
 #else
     return biton32(default_layer_state);
 #endif
@@ -219,7 +274,7 @@ static uint8_t config_keymap(uint8_t keycode)
 
 static action_t get_action(uint8_t layer, keypos_t key)
 {
-    action_t act = action_for_key(layer, key);
+    action_t act = ACTION_FOR_KEY(layer, key);
     switch (act.kind.id) {
         case ACT_LMODS:
         case ACT_RMODS:
@@ -239,7 +294,7 @@ static action_t get_action(uint8_t layer, keypos_t key)
 #else
 static action_t get_action(uint8_t layer, keypos_t key)
 {
-    return action_for_key(layer, key);
+    return ACTION_FOR_KEY(layer, key);
 }
 #endif
 
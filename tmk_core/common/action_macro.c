@@ -14,10 +14,12 @@ GNU General Public License for more details.
 You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
+#include <stddef.h>
 #include "action.h"
 #include "action_util.h"
 #include "action_macro.h"
-#include "wait.h"
+#include "host.h"
+#include "timer.h"
 
 #ifdef DEBUG_ACTION
 #include "debug.h"
@@ -28,71 +30,160 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #ifndef NO_ACTION_MACRO
 
-#define MACRO_READ()  (macro = MACRO_GET(macro_p++))
+/*
+ * Macro player
+ *
+ * action_macro_play() only puts macro in queue and action_macro_task()
+ * plays it from keyboard_task() step by step, so that matrix scan and USB
+ * go on while macro is played. A step which changes report waits until
+ * host driver has no keyboard report pending(host_keyboard_pending()), so
+ * that macro goes at the pace host polls and never overflows report queue.
+ * With driver which doesn't tell it a step per 1ms at most.
+ * INTERVAL and WAIT add time to it. Key events found meanwhile are held and
+ * executed in order after the macros, also when no report is pending.
+ */
+static const macro_t *queue[ACTION_MACRO_QUEUE_SIZE];
+static uint8_t queue_head = 0;
+static uint8_t queue_count = 0;
+
+static keyevent_t held[ACTION_MACRO_HOLD_SIZE];
+static uint8_t held_head = 0;
+static uint8_t held_count = 0;
+
+static struct {
+    const macro_t *macro_p;     /* next command, NULL when idle */
+    uint16_t time;              /* when delay started */
+    uint16_t delay;             /* ms to wait before next command */
+    uint8_t interval;
+    uint8_t mod_storage;
+    bool sent;                  /* report of last step may be pending */
+} player;
+
+
 void action_macro_play(const macro_t *macro_p)
 {
-    macro_t macro = END;
-    uint8_t interval = 0;
+    if (!macro_p) return;
+    if (queue_count == ACTION_MACRO_QUEUE_SIZE) {
+        dprint("MACRO: queue full\n");
+        return;
+    }
+    queue[(queue_head + queue_count++) % ACTION_MACRO_QUEUE_SIZE] = macro_p;
+}
 
-    uint8_t mod_storage = 0;
+bool action_macro_playing(void)
+{
+    return player.macro_p || queue_count || held_count;
+}
 
-    if (!macro_p) return;
-    while (true) {
-        switch (MACRO_READ()) {
-            case KEY_DOWN:
-                MACRO_READ();
-                dprintf("KEY_DOWN(%02X)\n", macro);
-                if (IS_MOD(macro)) {
-                    add_weak_mods(MOD_BIT(macro));
-                    send_keyboard_report();
-                } else {
-                    register_code(macro);
-                }
-                break;
-            case KEY_UP:
-                MACRO_READ();
-                dprintf("KEY_UP(%02X)\n", macro);
-                if (IS_MOD(macro)) {
-                    del_weak_mods(MOD_BIT(macro));
-                    send_keyboard_report();
-                } else {
-                    unregister_code(macro);
-                }
-                break;
-            case WAIT:
-                MACRO_READ();
-                dprintf("WAIT(%u)\n", macro);
-                { uint8_t ms = macro; while (ms--) wait_ms(1); }
-                break;
-            case INTERVAL:
-                interval = MACRO_READ();
-                dprintf("INTERVAL(%u)\n", interval);
-                break;
-            case MOD_STORE:
-                mod_storage = get_mods();
-                break;
-            case MOD_RESTORE:
-                set_mods(mod_storage);
-                send_keyboard_report();
-                break;
-            case MOD_CLEAR:
-                clear_mods();
+bool action_macro_hold(keyevent_t event)
+{
+    if (held_count == ACTION_MACRO_HOLD_SIZE) return false;
+    held[(held_head + held_count++) % ACTION_MACRO_HOLD_SIZE] = event;
+    return true;
+}
+
+#define MACRO_READ()  (macro = MACRO_GET(player.macro_p++))
+/* executes a command, returns false at end of macro */
+static bool macro_step(void)
+{
+    macro_t macro = END;
+
+    switch (MACRO_READ()) {
+        case KEY_DOWN:
+            MACRO_READ();
+            dprintf("KEY_DOWN(%02X)\n", macro);
+            if (IS_MOD(macro)) {
+                add_weak_mods(MOD_BIT(macro));
                 send_keyboard_report();
-                break;
-            case 0x04 ... 0x73:
-                dprintf("DOWN(%02X)\n", macro);
+            } else {
                 register_code(macro);
-                break;
-            case 0x84 ... 0xF3:
-                dprintf("UP(%02X)\n", macro);
-                unregister_code(macro&0x7F);
-                break;
-            case END:
-            default:
-                return;
+            }
+            break;
+        case KEY_UP:
+            MACRO_READ();
+            dprintf("KEY_UP(%02X)\n", macro);
+            if (IS_MOD(macro)) {
+                del_weak_mods(MOD_BIT(macro));
+                send_keyboard_report();
+            } else {
+                unregister_code(macro);
+            }
+            break;
+        case WAIT:
+            MACRO_READ();
+            dprintf("WAIT(%u)\n", macro);
+            player.delay += macro;
+            goto interval;
+        case INTERVAL:
+            player.interval = MACRO_READ();
+            dprintf("INTERVAL(%u)\n", player.interval);
+            goto interval;
+        case MOD_STORE:
+            player.mod_storage = get_mods();
+            goto interval;
+        case MOD_RESTORE:
+            set_mods(player.mod_storage);
+            send_keyboard_report();
+            break;
+        case MOD_CLEAR:
+            clear_mods();
+            send_keyboard_report();
+            break;
+        case 0x04 ... 0x73:
+            dprintf("DOWN(%02X)\n", macro);
+            register_code(macro);
+            break;
+        case 0x84 ... 0xF3:
+            dprintf("UP(%02X)\n", macro);
+            unregister_code(macro&0x7F);
+            break;
+        case END:
+        default:
+            return false;
+    }
+    player.sent = true;
+interval:
+    player.delay += player.interval;
+    return true;
+}
+
+void action_macro_task(void)
+{
+    while (player.macro_p || queue_count) {
+        if (!player.macro_p) {
+            player.macro_p = queue[queue_head];
+            queue_head = (queue_head + 1) % ACTION_MACRO_QUEUE_SIZE;
+            queue_count--;
+            player.delay = 0;
+            player.interval = 0;
+            player.mod_storage = 0;
+        }
+
+        if (player.sent) {
+            if (host_keyboard_pending()) return;
+            player.sent = false;
+        }
+        if (player.delay) {
+            if (TIMER_DIFF_16(timer_read(), player.time) < player.delay) return;
+            player.delay = 0;
         }
-        // interval
-        { uint8_t ms = interval; while (ms--) wait_ms(1); }
+        if (!macro_step()) {
+            player.macro_p = NULL;
+        } else {
+            if (player.delay) player.time = timer_read();
+            // a report per call, pending one is checked next call
+            if (player.sent) return;
+        }
+    }
+
+    // events held behind macros at the same pace, stop when one of them
+    // starts macro again
+    while (held_count && !player.macro_p && !queue_count) {
+        if (host_keyboard_pending()) return;
+        keyevent_t e = held[held_head];
+        held_head = (held_head + 1) % ACTION_MACRO_HOLD_SIZE;
+        held_count--;
+        action_exec(e);
     }
 }
 #endif
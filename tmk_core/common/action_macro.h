@@ -17,7 +17,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef ACTION_MACRO_H
 #define ACTION_MACRO_H
 #include <stdint.h>
+#include <stdbool.h>
 #include "progmem.h"
+#include "keyboard.h"
 
 
 #define MACRO_NONE      0
@@ -27,10 +29,29 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 typedef uint8_t macro_t;
 
 
+/* number of macros waiting to be played */
+#ifndef ACTION_MACRO_QUEUE_SIZE
+#define ACTION_MACRO_QUEUE_SIZE 4
+#endif
+
+/* number of key events held while macro is played */
+#ifndef ACTION_MACRO_HOLD_SIZE
+#define ACTION_MACRO_HOLD_SIZE  8
+#endif
+
 #ifndef NO_ACTION_MACRO
+/* queues macro and returns, it is dropped when queue is full */
 void action_macro_play(const macro_t *macro_p);
+/* plays macros in queue, call from keyboard_task() */
+void action_macro_task(void);
+/* true while macro is played or key event is held */
+bool action_macro_playing(void);
+/* holds key event until macros end, false when no room */
+bool action_macro_hold(keyevent_t event);
 #else
 #define action_macro_play(macro)
+#define action_macro_task()
+#define action_macro_playing()  false
 #endif
 
 
@@ -42,6 +63,7 @@ void action_macro_play(const macro_t *macro_p);
  *   { KEY_UP,   code(0x04-0xff) }      // key up(2bytes)
  *   WAIT                               // wait milli-seconds
  *   INTERVAL                           // set interval between macro commands
+ *                                      // key command waits for host to take report
  *   END                                // stop macro execution
  *
  * Ideas(Not implemented):
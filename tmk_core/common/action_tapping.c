@@ -5,6 +5,8 @@
 #include "action_tapping.h"
 #include "keycode.h"
 #include "timer.h"
+#include "progmem.h"
+#include "latency_trace.h"
 
 #ifdef DEBUG_ACTION
 #include "debug.h"
@@ -18,7 +20,15 @@
 #define IS_TAPPING_PRESSED()    (IS_TAPPING() && tapping_key.event.pressed)
 #define IS_TAPPING_RELEASED()   (IS_TAPPING() && !tapping_key.event.pressed)
 #define IS_TAPPING_KEY(k)       (IS_TAPPING() && KEYEQ(tapping_key.event.key, (k)))
-#define WITHIN_TAPPING_TERM(e)  (TIMER_DIFF_16(e.time, tapping_key.event.time) < TAPPING_TERM)
+#define WITHIN_TAPPING_TERM(e)  (TIMER_DIFF_16(e.time, tapping_key.event.time) < tapping_term())
+#define WITHIN_QUICK_TAP(e)     (TIMER_DIFF_16(e.time, tapping_key.event.time) < tapping_quick())
+
+#if (WAITING_BUFFER_SIZE < 2 || WAITING_BUFFER_SIZE > 255)
+#   error "WAITING_BUFFER_SIZE must be 2 to 255"
+#endif
+#if TAPPING_TERM >= 500 && !defined(TAPPING_PERMISSIVE_HOLD)
+#   define TAPPING_PERMISSIVE_HOLD
+#endif
 
 
 static keyrecord_t tapping_key = {};
@@ -28,35 +38,79 @@ static uint8_t waiting_buffer_tail = 0;
 
 static bool process_tapping(keyrecord_t *record);
 static bool waiting_buffer_enq(keyrecord_t record);
-static void waiting_buffer_clear(void);
+static void waiting_buffer_process(keyrecord_t record);
+static void tapping_settle(void);
 static bool waiting_buffer_typed(keyevent_t event);
 static void waiting_buffer_scan_tap(void);
 static void debug_tapping_key(void);
 static void debug_waiting_buffer(void);
 
 
+#ifdef TAPPING_CONFIG_ENABLE
+/* config of tapping key, loaded when key changes */
+static keypos_t config_key = { .col = 255, .row = 255 };
+static uint16_t config_term = TAPPING_TERM;
+static uint16_t config_quick = TAPPING_TERM;
+static uint8_t config_flags = 0;
+
+/* tap key held over term with TAPPING_RETRO */
+static keypos_t retro_key = { .col = 255, .row = 255 };
+
+static void tapping_config_load(void)
+{
+    if (KEYEQ(config_key, tapping_key.event.key)) return;
+
+    config_key = tapping_key.event.key;
+    config_term = TAPPING_TERM;
+    config_quick = TAPPING_TERM;
+    config_flags = 0;
+    for (const tapping_config_t *p = tapping_config; ; p++) {
+        keypos_t key = { .col = pgm_read_byte(&p->key.col), .row = pgm_read_byte(&p->key.row) };
+        if (key.col == 255 && key.row == 255) break;
+        if (KEYEQ(key, config_key)) {
+            config_term = pgm_read_word(&p->term);
+            config_quick = pgm_read_word(&p->quick);
+            config_flags = pgm_read_byte(&p->flags);
+            break;
+        }
+    }
+}
+
+static uint16_t tapping_term(void)  { tapping_config_load(); return config_term; }
+static uint16_t tapping_quick(void) { tapping_config_load(); return config_quick; }
+static uint8_t tapping_flags(void)  { tapping_config_load(); return config_flags; }
+#else
+#define tapping_term()  TAPPING_TERM
+#define tapping_quick() TAPPING_TERM
+#endif
+
+
 void action_tapping_process(keyrecord_t record)
 {
     if (process_tapping(&record)) {
+        LATENCY_TRACE(LATENCY_TRACE_TAPPING);
         if (!IS_NOEVENT(record.event)) {
             debug("processed: "); debug_record(record); debug("\n");
         }
     } else {
-        if (!waiting_buffer_enq(record)) {
-            // clear all in case of overflow.
-            debug("OVERFLOW: CLEAR ALL STATES\n");
-            clear_keyboard();
-            waiting_buffer_clear();
-            tapping_key = (keyrecord_t){};
+        while (!waiting_buffer_enq(record)) {
+            // settle tapping early to make room, buffer gets one event shorter at least
+            debug("OVERFLOW: SETTLE TAPPING\n");
+            tapping_settle();
+            waiting_buffer_process(record);
         }
     }
+    waiting_buffer_process(record);
+}
 
-    // process waiting_buffer
+static void waiting_buffer_process(keyrecord_t record)
+{
     if (!IS_NOEVENT(record.event) && waiting_buffer_head != waiting_buffer_tail) {
         debug("---- action_exec: process waiting_buffer -----\n");
     }
     for (; waiting_buffer_tail != waiting_buffer_head; waiting_buffer_tail = (waiting_buffer_tail + 1) % WAITING_BUFFER_SIZE) {
         if (process_tapping(&waiting_buffer[waiting_buffer_tail])) {
+            LATENCY_TRACE(LATENCY_TRACE_TAPPING);
             debug("processed: waiting_buffer["); debug_dec(waiting_buffer_tail); debug("] = ");
             debug_record(waiting_buffer[waiting_buffer_tail]); debug("\n\n");
         } else {
@@ -95,7 +149,7 @@ bool process_tapping(keyrecord_t *keyp)
                     // enqueue
                     return false;
                 }
-#if TAPPING_TERM >= 500
+#ifdef TAPPING_PERMISSIVE_HOLD
                 /* Process a key typed within TAPPING_TERM
                  * This can register the key before settlement of tapping,
                  * useful for long TAPPING_TERM but may prevent fast typing.
@@ -133,6 +187,16 @@ bool process_tapping(keyrecord_t *keyp)
                     process_action(keyp);
                     return true;
                 }
+#ifdef TAPPING_HOLD_ON_OTHER_KEY_PRESS
+                else if (event.pressed) {
+                    debug("Tapping: End. No tap. Interfered by pressing key\n");
+                    process_action(&tapping_key);
+                    tapping_key = (keyrecord_t){};
+                    debug_tapping_key();
+                    // enqueue
+                    return false;
+                }
+#endif
                 else {
                     // set interrupted flag when other key preesed during tapping
                     if (event.pressed) {
@@ -185,6 +249,11 @@ bool process_tapping(keyrecord_t *keyp)
                 debug("Tapping: End. Timeout. Not tap(0): ");
                 debug_event(event); debug("\n");
                 process_action(&tapping_key);
+#ifdef TAPPING_CONFIG_ENABLE
+                if ((tapping_flags() & TAPPING_RETRO) && !tapping_key.tap.interrupted) {
+                    retro_key = tapping_key.event.key;
+                }
+#endif
                 tapping_key = (keyrecord_t){};
                 debug_tapping_key();
                 return false;
@@ -224,7 +293,7 @@ bool process_tapping(keyrecord_t *keyp)
             }
         }
     } else if (IS_TAPPING_RELEASED()) {
-        if (WITHIN_TAPPING_TERM(event)) {
+        if (WITHIN_QUICK_TAP(event)) {
             if (event.pressed) {
                 if (IS_TAPPING_KEY(event.key)) {
                     if (!tapping_key.tap.interrupted && tapping_key.tap.count > 0) {
@@ -272,6 +341,11 @@ bool process_tapping(keyrecord_t *keyp)
     }
     // not tapping state
     else {
+#ifdef TAPPING_CONFIG_ENABLE
+        // any other event cancels retro tap
+        bool retro = IS_RELEASED(event) && KEYEQ(event.key, retro_key);
+        if (!IS_NOEVENT(event)) retro_key = (keypos_t){ .col = 255, .row = 255 };
+#endif
         if (event.pressed && is_tap_key(event)) {
             debug("Tapping: Start(Press tap key).\n");
             tapping_key = *keyp;
@@ -280,6 +354,16 @@ bool process_tapping(keyrecord_t *keyp)
             return true;
         } else {
             process_action(keyp);
+#ifdef TAPPING_CONFIG_ENABLE
+            if (retro) {
+                debug("Tapping: Retro tap after hold.\n");
+                keyrecord_t tap = { .event = event, .tap = { .count = 1 } };
+                tap.event.pressed = true;
+                process_action(&tap);
+                tap.event.pressed = false;
+                process_action(&tap);
+            }
+#endif
             return true;
         }
     }
@@ -307,10 +391,16 @@ bool waiting_buffer_enq(keyrecord_t record)
     return true;
 }
 
-void waiting_buffer_clear(void)
+/* Ends tapping now, key is held if not tapped yet. Events in buffer are
+ * processed as they come after it. */
+void tapping_settle(void)
 {
-    waiting_buffer_head = 0;
-    waiting_buffer_tail = 0;
+    if (IS_TAPPING_PRESSED() && tapping_key.tap.count == 0) {
+        debug("Tapping: End. No tap. Settled early\n");
+        process_action(&tapping_key);
+    }
+    tapping_key = (keyrecord_t){};
+    debug_tapping_key();
 }
 
 bool waiting_buffer_typed(keyevent_t event)
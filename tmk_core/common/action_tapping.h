@@ -17,6 +17,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef ACTION_TAPPING_H
 #define ACTION_TAPPING_H
 
+#include <stdint.h>
+#include "keyboard.h"
+#include "progmem.h"
 
 
 /* period of tapping(ms) */
@@ -29,11 +32,49 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define TAPPING_TOGGLE  5
 #endif
 
+/* key events held while tapping is undecided, one less than this
+ * When it is full tapping key is settled as hold to make room. */
+#ifndef WAITING_BUFFER_SIZE
 #define WAITING_BUFFER_SIZE 8
+#endif
+
+/* Tapping key is settled as hold before TAPPING_TERM
+ *   TAPPING_PERMISSIVE_HOLD            when other key is pressed and released
+ *   TAPPING_HOLD_ON_OTHER_KEY_PRESS    when other key is pressed
+ * Former is always on with TAPPING_TERM of 500 or more.
+ */
+
+/* Tapping config of key
+ *
+ * With TAPPING_CONFIG_ENABLE keymap defines tapping_config[] in PROGMEM
+ * ended with TAPPING_CONFIG_END. It is looked up when tap key is pressed,
+ * keys not in it use TAPPING_TERM for both term and quick.
+ *
+ *   term   ms to release key for tap
+ *   quick  ms to press it again after tap to repeat tap, 0 never
+ *   flags  TAPPING_RETRO: tap on release after term unless other key is
+ *          pressed while it is held
+ */
+typedef struct {
+    keypos_t key;
+    uint16_t term;
+    uint16_t quick;
+    uint8_t  flags;
+} tapping_config_t;
+
+#define TAPPING_RETRO       0x01
+
+#define TAPPING_CONFIG(r, c, t, q, f) \
+    { .key = { .col = (c), .row = (r) }, .term = (t), .quick = (q), .flags = (f) }
+#define TAPPING_CONFIG_END  { .key = { .col = 255, .row = 255 } }
 
 
 #ifndef NO_ACTION_TAPPING
 void action_tapping_process(keyrecord_t record);
 #endif
 
+#ifdef TAPPING_CONFIG_ENABLE
+extern const tapping_config_t tapping_config[];
+#endif
+
 #endif
@@ -14,11 +14,14 @@ GNU General Public License for more details.
 You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
+#include <string.h>
 #include "host.h"
 #include "report.h"
 #include "debug.h"
+#include "util.h"
 #include "action_util.h"
 #include "timer.h"
+#include "latency_trace.h"
 
 static inline void add_key_byte(uint8_t code);
 static inline void del_key_byte(uint8_t code);
@@ -30,7 +33,32 @@ static inline void del_key_bit(uint8_t code);
 static uint8_t real_mods = 0;
 static uint8_t weak_mods = 0;
 
-#ifdef USB_6KRO_ENABLE
+#ifdef REPORT_INDEX_ENABLE
+/*
+ * Index of keys in report
+ *
+ * key_bits has a bit for each keycode in keys[] and key_count is number of
+ * keys in report of either byte or bit format.
+ * Without USB_6KRO_ENABLE key takes the first empty slot as before and
+ * empty slots are kept in free_slots. With USB_6KRO_ENABLE keys are packed
+ * in order of press and the oldest is pushed out when report is full.
+ */
+static uint8_t key_bits[32];
+static uint8_t key_count = 0;
+#define KEY_BIT(code)   (key_bits[(code)>>3] & (1<<((code)&7)))
+#ifndef USB_6KRO_ENABLE
+#   if (KEYBOARD_REPORT_KEYS <= 8)
+typedef uint8_t     slots_t;
+#       define SLOT_NUM(bits)  biton(bits)
+#   else
+typedef uint32_t    slots_t;
+#       define SLOT_NUM(bits)  biton32(bits)
+#   endif
+#   define SLOTS_ALL   ((slots_t)((1ULL<<KEYBOARD_REPORT_KEYS) - 1))
+static slots_t free_slots = SLOTS_ALL;
+#endif
+
+#elif defined(USB_6KRO_ENABLE)
 #define RO_ADD(a, b) ((a + b) % KEYBOARD_REPORT_KEYS)
 #define RO_SUB(a, b) ((a - b + KEYBOARD_REPORT_KEYS) % KEYBOARD_REPORT_KEYS)
 #define RO_INC(a) RO_ADD(a, 1)
@@ -75,6 +103,7 @@ void send_keyboard_report(void) {
 /* key */
 void add_key(uint8_t key)
 {
+    LATENCY_TRACE(LATENCY_TRACE_ADD_KEY);
 #if defined(NKRO_ENABLE) || defined(NKRO_6KRO_ENABLE)
     if (keyboard_protocol && keyboard_nkro) {
         add_key_bit(key);
@@ -101,6 +130,13 @@ void clear_keys(void)
     for (int8_t i = 1; i < KEYBOARD_REPORT_SIZE; i++) {
         keyboard_report->raw[i] = 0;
     }
+#ifdef REPORT_INDEX_ENABLE
+    memset(key_bits, 0, sizeof(key_bits));
+    key_count = 0;
+#   ifndef USB_6KRO_ENABLE
+    free_slots = SLOTS_ALL;
+#   endif
+#endif
 }
 
 
@@ -144,12 +180,16 @@ void clear_oneshot_mods(void)
  */
 uint8_t has_anykey(void)
 {
+#ifdef REPORT_INDEX_ENABLE
+    return key_count;
+#else
     uint8_t cnt = 0;
     for (uint8_t i = 1; i < KEYBOARD_REPORT_SIZE; i++) {
         if (keyboard_report->raw[i])
             cnt++;
     }
     return cnt;
+#endif
 }
 
 uint8_t has_anymod(void)
@@ -167,7 +207,7 @@ uint8_t get_first_key(void)
         return i<<3 | biton(keyboard_report->nkro.bits[i]);
     }
 #endif
-#ifdef USB_6KRO_ENABLE
+#if defined(USB_6KRO_ENABLE) && !defined(REPORT_INDEX_ENABLE)
     uint8_t i = cb_head;
     do {
         if (keyboard_report->keys[i] != 0) {
@@ -184,6 +224,49 @@ uint8_t get_first_key(void)
 
 
 /* local functions */
+#ifdef REPORT_INDEX_ENABLE
+static inline void add_key_byte(uint8_t code)
+{
+    if (!code || KEY_BIT(code)) return;
+
+#ifdef USB_6KRO_ENABLE
+    if (key_count == KEYBOARD_REPORT_KEYS) {
+        // push out the oldest
+        uint8_t old = keyboard_report->keys[0];
+        key_bits[old>>3] &= ~(1<<(old&7));
+        memmove(&keyboard_report->keys[0], &keyboard_report->keys[1], KEYBOARD_REPORT_KEYS - 1);
+        key_count--;
+    }
+    keyboard_report->keys[key_count] = code;
+#else
+    if (!free_slots) return;
+    // lowest empty slot
+    uint8_t i = SLOT_NUM(free_slots & -free_slots);
+    free_slots &= ~((slots_t)1<<i);
+    keyboard_report->keys[i] = code;
+#endif
+    key_bits[code>>3] |= 1<<(code&7);
+    key_count++;
+}
+
+static inline void del_key_byte(uint8_t code)
+{
+    if (!code || !KEY_BIT(code)) return;
+
+    uint8_t i = 0;
+    while (keyboard_report->keys[i] != code) i++;
+#ifdef USB_6KRO_ENABLE
+    memmove(&keyboard_report->keys[i], &keyboard_report->keys[i + 1], key_count - i - 1);
+    keyboard_report->keys[key_count - 1] = 0;
+#else
+    keyboard_report->keys[i] = 0;
+    free_slots |= ((slots_t)1<<i);
+#endif
+    key_bits[code>>3] &= ~(1<<(code&7));
+    key_count--;
+}
+
+#else
 static inline void add_key_byte(uint8_t code)
 {
 #ifdef USB_6KRO_ENABLE
@@ -285,11 +368,15 @@ static inline void del_key_byte(uint8_t code)
     }
 #endif
 }
+#endif
 
 #if defined(NKRO_ENABLE) || defined(NKRO_6KRO_ENABLE)
 static inline void add_key_bit(uint8_t code)
 {
     if ((code>>3) < KEYBOARD_REPORT_BITS) {
+#ifdef REPORT_INDEX_ENABLE
+        if (!(keyboard_report->nkro.bits[code>>3] & 1<<(code&7))) key_count++;
+#endif
         keyboard_report->nkro.bits[code>>3] |= 1<<(code&7);
     } else {
         dprintf("add_key_bit: can't add: %02X\n", code);
@@ -299,6 +386,9 @@ static inline void add_key_bit(uint8_t code)
 static inline void del_key_bit(uint8_t code)
 {
     if ((code>>3) < KEYBOARD_REPORT_BITS) {
+#ifdef REPORT_INDEX_ENABLE
+        if (keyboard_report->nkro.bits[code>>3] & 1<<(code&7)) key_count--;
+#endif
         keyboard_report->nkro.bits[code>>3] &= ~(1<<(code&7));
     } else {
         dprintf("del_key_bit: can't del: %02X\n", code);
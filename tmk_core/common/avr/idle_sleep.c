@@ -0,0 +1,107 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include "timer.h"
+#include "matrix.h"
+#include "action_macro.h"
+#include "idle_sleep.h"
+
+
+/* Timer0 CTC counts 0..TIMER_RAW_TOP */
+#define TICKS_PER_MS    (TIMER_RAW_TOP + 1)
+
+static uint16_t last_active = 0;
+/* ticks at last wakeup, 0 while running at full rate */
+static uint32_t wake = 0;
+
+static uint32_t stat_start = 0;
+static uint32_t slept = 0;
+static uint16_t sleeps = 0;
+static uint16_t busy_max = 0;
+static idle_sleep_stat_t stat;
+
+
+/* call with interrupt off */
+static uint32_t ticks(void)
+{
+    uint32_t ms = timer_count;
+    uint8_t raw = TIMER_RAW;
+    /* compare match occurred but timer_count is not updated yet */
+#ifdef TIFR0
+    if (TIFR0 & (1<<OCF0A)) {
+#else
+    if (TIFR & (1<<OCF0A)) {
+#endif
+        ms++;
+        raw = TIMER_RAW;
+    }
+    return ms * TICKS_PER_MS + raw;
+}
+
+static bool active(void)
+{
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        if (matrix_get_row(r)) return true;
+    }
+    return action_macro_playing();
+}
+
+void idle_sleep_task(void)
+{
+    if (active()) {
+        last_active = timer_read();
+        wake = 0;
+        return;
+    }
+    if (timer_elapsed(last_active) < IDLE_SLEEP_DELAY) return;
+
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    cli();
+    uint32_t t = ticks();
+    if (wake && t - wake > busy_max) {
+        busy_max = (t - wake > UINT16_MAX) ? UINT16_MAX : t - wake;
+    }
+    sleep_enable();
+    sei();
+    sleep_cpu();
+    sleep_disable();
+    cli();
+    wake = ticks();
+    sei();
+
+    slept += wake - t;
+    if (sleeps != UINT16_MAX) sleeps++;
+}
+
+const idle_sleep_stat_t *idle_sleep_stat(void)
+{
+    uint8_t sreg = SREG;
+    cli();
+    uint32_t total = ticks() - stat_start;
+    SREG = sreg;
+
+    /* scale down to keep multiplication in 32 bits */
+    uint32_t s = slept;
+    while (total >> 22) {
+        total >>= 1;
+        s >>= 1;
+    }
+    stat.duty = total ? 1000 - (uint16_t)(s * 1000 / total) : 1000;
+    stat.sleeps = sleeps;
+    stat.busy_max = (uint32_t)busy_max * 1000 / TICKS_PER_MS;
+    return &stat;
+}
+
+void idle_sleep_clear_stat(void)
+{
+    uint8_t sreg = SREG;
+    cli();
+    stat_start = ticks();
+    SREG = sreg;
+
+    slept = 0;
+    sleeps = 0;
+    busy_max = 0;
+}
@@ -0,0 +1,150 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <util/delay.h>
+#include "timer.h"
+#include "matrix.h"
+#include "matrix_pipeline.h"
+
+
+/*
+ * matrix_scan() reads one column per call instead of whole matrix so that
+ * keyboard_task() gets events of the column without waiting for rest of the
+ * scan. Columns are read in round robin and a column changed in last
+ * MATRIX_SCAN_ACTIVE ms is read again between them, at most
+ * MATRIX_SCAN_ACTIVE_TURNS times in a round. Keys only held down don't make
+ * their column active.
+ *
+ * KEY_STATE needs MATRIX_SCAN_RECOVERY us to return to idle after
+ * KEY_UNABLE. It is measured with TIMER_RAW instead of fixed delay so that
+ * delays of next key and time out of matrix_scan() are not waited again.
+ * This saves 12us a key against full scan, MATRIX_SCAN_RECOVERY + 19us, and
+ * default of MATRIX_SCAN_ACTIVE_TURNS is columns the saving of a round pays
+ * for. A round with active turns is no slower than full scan.
+ */
+#ifndef MATRIX_SCAN_RECOVERY
+#   error "MATRIX_SCAN_RECOVERY is not defined in config.h."
+#endif
+#ifndef MATRIX_SCAN_ACTIVE
+#define MATRIX_SCAN_ACTIVE      50
+#endif
+#ifndef MATRIX_SCAN_ACTIVE_TURNS
+#define MATRIX_SCAN_ACTIVE_TURNS    (MATRIX_COLS * 12 / (MATRIX_SCAN_RECOVERY + 7))
+#endif
+// ticks to wait before SET_ROW, 12us of delays to KEY_ENABLE count for recovery and +1 for tick in progress
+#define RECOVERY_WAIT   (((MATRIX_SCAN_RECOVERY - 12) * (TIMER_RAW_FREQ / 1000UL) + 999) / 1000 + 1)
+#if (MATRIX_SCAN_RECOVERY < 12 || RECOVERY_WAIT > TIMER_RAW_TOP)
+#   error "MATRIX_SCAN_RECOVERY is out of range."
+#endif
+#if (MATRIX_SCAN_ACTIVE_TURNS > 255)
+#   error "MATRIX_SCAN_ACTIVE_TURNS is out of range."
+#endif
+
+// matrix state(1:on, 0:off), updated in place
+static matrix_row_t matrix[MATRIX_ROWS];
+static uint8_t unabled_at = 0;
+static uint8_t next_col = 0;
+static uint8_t next_active = 0;
+static bool active_turn = false;
+static uint8_t active_left = MATRIX_SCAN_ACTIVE_TURNS;
+static matrix_row_t recent = 0;
+static uint16_t recent_time[MATRIX_COLS];
+
+
+/* TIMER_RAW counts 0 to TIMER_RAW_TOP */
+static inline uint8_t raw_elapsed(uint8_t since)
+{
+    uint8_t now = TIMER_RAW;
+    return (now >= since) ? now - since : now + (TIMER_RAW_TOP + 1) - since;
+}
+
+static void scan_col(uint8_t col)
+{
+    matrix_row_t mask = (matrix_row_t)1<<col;
+    bool changed = false;
+
+    matrix_pipeline_set_col(col);
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        bool prev = matrix[row] & mask;
+
+        // Delays before KEY_ENABLE and time out of matrix_scan() count for recovery.
+        // Wait is MATRIX_SCAN_RECOVERY at most even if TIMER_RAW wraps in between.
+        while (raw_elapsed(unabled_at) < RECOVERY_WAIT) ;
+
+        matrix_pipeline_set_row(row);
+        _delay_us(2);
+
+        if (prev) {
+            matrix_pipeline_hys_on();
+        }
+        _delay_us(10);
+
+        uint8_t last = TIMER_RAW;
+
+        matrix_pipeline_key_enable();
+
+        // Wait for KEY_STATE outputs its value.
+        _delay_us(2);
+
+        bool on = !matrix_pipeline_key_state();
+
+        // KEY_STATE is valid only in 20us after KEY_ENABLE
+        if (TIMER_DIFF_RAW(TIMER_RAW, last) > 20/(1000000/TIMER_RAW_FREQ)) {
+            on = prev;
+        }
+
+        _delay_us(5);
+        matrix_pipeline_hys_off();
+        matrix_pipeline_key_unable();
+        unabled_at = TIMER_RAW;
+
+        if (on != prev) {
+            matrix[row] ^= mask;
+            changed = true;
+        }
+    }
+    if (changed) {
+        recent |= mask;
+        recent_time[col] = timer_read();
+    }
+}
+
+/* changed in last MATRIX_SCAN_ACTIVE ms */
+static bool col_active(uint8_t col)
+{
+    matrix_row_t mask = (matrix_row_t)1<<col;
+    if (!(recent & mask)) return false;
+    if (timer_elapsed(recent_time[col]) < MATRIX_SCAN_ACTIVE) return true;
+    recent &= ~mask;
+    return false;
+}
+
+uint8_t matrix_scan(void)
+{
+    // active column and next of round robin in turn while active turns of the round last
+    uint8_t col = next_col;
+    if (active_turn && active_left && recent) {
+        for (uint8_t i = 0; i < MATRIX_COLS; i++) {
+            uint8_t c = (next_active + i) % MATRIX_COLS;
+            if (col_active(c)) {
+                col = c;
+                next_active = (c + 1) % MATRIX_COLS;
+                break;
+            }
+        }
+    }
+    active_turn = !active_turn;
+    if (col == next_col) {
+        next_col = (next_col + 1) % MATRIX_COLS;
+        if (next_col == 0) active_left = MATRIX_SCAN_ACTIVE_TURNS;
+    } else {
+        active_left--;
+    }
+
+    scan_col(col);
+    return 1;
+}
+
+matrix_row_t matrix_get_row(uint8_t row)
+{
+    return matrix[row];
+}
@@ -0,0 +1,38 @@
+#ifndef MATRIX_PIPELINE_H
+#define MATRIX_PIPELINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*
+ * Pipelined scan of Topre controller(fc660c, fc980c)
+ *
+ * matrix_scan() and matrix_get_row() of common/avr/matrix_pipeline.c read
+ * one column per call instead of whole matrix, see there. Board opts in
+ * with MATRIX_SCAN_PIPELINE_ENABLE = yes, gives MATRIX_SCAN_RECOVERY in
+ * config.h and implements these with KEY_* and SET_ROW/COL of its
+ * controller, e.g.
+ *
+ *      void matrix_pipeline_set_col(uint8_t col) { SET_COL(col); }
+ *      bool matrix_pipeline_key_state(void) { return KEY_STATE(); }
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* implemented by board */
+void matrix_pipeline_set_col(uint8_t col);
+void matrix_pipeline_set_row(uint8_t row);
+void matrix_pipeline_key_enable(void);
+void matrix_pipeline_key_unable(void);
+bool matrix_pipeline_key_state(void);
+void matrix_pipeline_hys_on(void);
+void matrix_pipeline_hys_off(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
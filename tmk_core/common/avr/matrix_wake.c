@@ -0,0 +1,63 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "timer.h"
+#include "matrix.h"
+#include "matrix_wake.h"
+
+
+static bool waiting = false;
+static volatile bool woken = false;
+static uint16_t last_active = 0;
+
+
+bool matrix_wake_task(void)
+{
+    if (waiting) {
+        if (!woken && !matrix_wake_key()) return false;
+        matrix_power_up();
+        return true;
+    }
+
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        if (matrix_get_row(r)) {
+            last_active = timer_read();
+            return true;
+        }
+    }
+    if (timer_elapsed(last_active) < MATRIX_WAKE_IDLE) return true;
+
+    matrix_power_down();
+    return false;
+}
+
+void matrix_wake_start(void)
+{
+    waiting = true;
+    woken = false;
+#ifdef MATRIX_WAKE_PCMSK
+    PCMSK0 |= MATRIX_WAKE_PCMSK;
+    PCIFR = (1<<PCIF0);
+    PCICR |= (1<<PCIE0);
+#endif
+}
+
+void matrix_wake_stop(void)
+{
+#ifdef MATRIX_WAKE_PCMSK
+    PCICR &= ~(1<<PCIE0);
+    PCMSK0 &= (uint8_t)~(MATRIX_WAKE_PCMSK);
+#endif
+    waiting = false;
+    last_active = timer_read();
+}
+
+#ifdef MATRIX_WAKE_PCMSK
+/* only to wake up, once until next start since contacts bounce */
+ISR(PCINT0_vect)
+{
+    PCICR &= ~(1<<PCIE0);
+    woken = true;
+}
+#endif
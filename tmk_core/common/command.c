@@ -32,6 +32,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "led.h"
 #include "command.h"
 #include "backlight.h"
+#include "latency_trace.h"
 
 #ifdef MOUSEKEY_ENABLE
 #include "mousekey.h"
@@ -48,6 +49,24 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #   include "usbdrv.h"
 #endif
 
+#if defined(PROTOCOL_LUFA) && defined(REPORT_QUEUE_SIZE)
+#   include "lufa.h"
+#endif
+
+#ifdef SOF_SCAN_PHASE
+#   include "sof_scan.h"
+#endif
+
+#ifdef IDLE_SLEEP_ENABLE
+#   include "idle_sleep.h"
+#endif
+
+#include "console.h"
+
+
+/* long output gives console driver time to send each line */
+#define print_yield(s)  do { print(s); console_yield(); } while (0)
+
 
 static bool command_common(uint8_t code);
 static void command_common_help(void);
@@ -114,33 +133,36 @@ bool command_console_extra(uint8_t code)
  ***********************************************************/
 static void command_common_help(void)
 {
-    print("\n\t- Magic -\n"
-          "d:	debug\n"
-          "x:	debug matrix\n"
-          "k:	debug keyboard\n"
-          "m:	debug mouse\n"
-          "v:	version\n"
-          "s:	status\n"
-          "c:	console mode\n"
-          "0-4:	layer0-4(F10-F4)\n"
-          "Paus:	bootloader\n"
+    print_yield("\n\t- Magic -\n");
+    print_yield("d:	debug\n");
+    print_yield("x:	debug matrix\n");
+    print_yield("k:	debug keyboard\n");
+    print_yield("m:	debug mouse\n");
+    print_yield("v:	version\n");
+    print_yield("s:	status\n");
+    print_yield("c:	console mode\n");
+    print_yield("0-4:	layer0-4(F10-F4)\n");
+    print_yield("Paus:	bootloader\n");
 
 #ifdef KEYBOARD_LOCK_ENABLE
-          "Caps:	Lock\n"
+    print_yield("Caps:	Lock\n");
 #endif
 
 #ifdef BOOTMAGIC_ENABLE
-          "e:	eeprom\n"
+    print_yield("e:	eeprom\n");
 #endif
 
 #if defined(NKRO_ENABLE) || defined(NKRO_6KRO_ENABLE)
-          "n:	NKRO\n"
+    print_yield("n:	NKRO\n");
 #endif
 
 #ifdef SLEEP_LED_ENABLE
-          "z:	sleep LED test\n"
+    print_yield("z:	sleep LED test\n");
+#endif
+
+#ifdef LATENCY_TRACE_ENABLE
+    print_yield("l:	latency trace\n");
 #endif
-    );
 }
 
 #ifdef BOOTMAGIC_ENABLE
@@ -149,34 +171,34 @@ __attribute__ ((weak)) void eeconfig_debug(void) {}
 
 static void print_eeconfig(void)
 {
-    print("default_layer: "); print_dec(eeconfig_read_default_layer()); print("\n");
+    print("default_layer: "); print_dec(eeconfig_read_default_layer()); print_yield("\n");
 
     debug_config_t dc;
     dc.raw = eeconfig_read_debug();
-    print("debug_config.raw: "); print_hex8(dc.raw); print("\n");
-    print(".enable: "); print_dec(dc.enable); print("\n");
-    print(".matrix: "); print_dec(dc.matrix); print("\n");
-    print(".keyboard: "); print_dec(dc.keyboard); print("\n");
-    print(".mouse: "); print_dec(dc.mouse); print("\n");
+    print("debug_config.raw: "); print_hex8(dc.raw); print_yield("\n");
+    print(".enable: "); print_dec(dc.enable); print_yield("\n");
+    print(".matrix: "); print_dec(dc.matrix); print_yield("\n");
+    print(".keyboard: "); print_dec(dc.keyboard); print_yield("\n");
+    print(".mouse: "); print_dec(dc.mouse); print_yield("\n");
 
     keymap_config_t kc;
     kc.raw = eeconfig_read_keymap();
-    print("keymap_config.raw: "); print_hex8(kc.raw); print("\n");
-    print(".swap_control_capslock: "); print_dec(kc.swap_control_capslock); print("\n");
-    print(".capslock_to_control: "); print_dec(kc.capslock_to_control); print("\n");
-    print(".swap_lalt_lgui: "); print_dec(kc.swap_lalt_lgui); print("\n");
-    print(".swap_ralt_rgui: "); print_dec(kc.swap_ralt_rgui); print("\n");
-    print(".no_gui: "); print_dec(kc.no_gui); print("\n");
-    print(".swap_grave_esc: "); print_dec(kc.swap_grave_esc); print("\n");
-    print(".swap_backslash_backspace: "); print_dec(kc.swap_backslash_backspace); print("\n");
-    print(".nkro: "); print_dec(kc.nkro); print("\n");
+    print("keymap_config.raw: "); print_hex8(kc.raw); print_yield("\n");
+    print(".swap_control_capslock: "); print_dec(kc.swap_control_capslock); print_yield("\n");
+    print(".capslock_to_control: "); print_dec(kc.capslock_to_control); print_yield("\n");
+    print(".swap_lalt_lgui: "); print_dec(kc.swap_lalt_lgui); print_yield("\n");
+    print(".swap_ralt_rgui: "); print_dec(kc.swap_ralt_rgui); print_yield("\n");
+    print(".no_gui: "); print_dec(kc.no_gui); print_yield("\n");
+    print(".swap_grave_esc: "); print_dec(kc.swap_grave_esc); print_yield("\n");
+    print(".swap_backslash_backspace: "); print_dec(kc.swap_backslash_backspace); print_yield("\n");
+    print(".nkro: "); print_dec(kc.nkro); print_yield("\n");
 
 #ifdef BACKLIGHT_ENABLE
     backlight_config_t bc;
     bc.raw = eeconfig_read_backlight();
-    print("backlight_config.raw: "); print_hex8(bc.raw); print("\n");
-    print(".enable: "); print_dec(bc.enable); print("\n");
-    print(".level: "); print_dec(bc.level); print("\n");
+    print("backlight_config.raw: "); print_hex8(bc.raw); print_yield("\n");
+    print(".enable: "); print_dec(bc.enable); print_yield("\n");
+    print(".level: "); print_dec(bc.level); print_yield("\n");
 #endif
 
     eeconfig_debug();
@@ -205,6 +227,13 @@ static bool command_common(uint8_t code)
             sleep_led_test = !sleep_led_test;
             break;
 #endif
+#ifdef LATENCY_TRACE_ENABLE
+        case KC_L:
+            // print latency stats and start new measurement
+            latency_trace_print();
+            latency_trace_clear();
+            break;
+#endif
 #ifdef BOOTMAGIC_ENABLE
         case KC_E:
             print("eeconfig:\n");
@@ -283,12 +312,12 @@ static bool command_common(uint8_t code)
             }
             break;
         case KC_V: // print version & information
-            print("\n\t- Version -\n");
-            print("DESC: " STR(DESCRIPTION) "\n");
-            print("VID: " STR(VENDOR_ID) "(" STR(MANUFACTURER) ") "
-                  "PID: " STR(PRODUCT_ID) "(" STR(PRODUCT) ") "
-                  "VER: " STR(DEVICE_VER) "\n");
-            print("BUILD: " STR(TMK_VERSION) " (" __TIME__ " " __DATE__ ")\n");
+            print_yield("\n\t- Version -\n");
+            print_yield("DESC: " STR(DESCRIPTION) "\n");
+            print_yield("VID: " STR(VENDOR_ID) "(" STR(MANUFACTURER) ") "
+                        "PID: " STR(PRODUCT_ID) "(" STR(PRODUCT) ") "
+                        "VER: " STR(DEVICE_VER) "\n");
+            print_yield("BUILD: " STR(TMK_VERSION) " (" __TIME__ " " __DATE__ ")\n");
             /* build options */
             print("OPTIONS:"
 #ifdef PROTOCOL_PJRC
@@ -323,8 +352,46 @@ static bool command_common(uint8_t code)
 #endif
 #ifdef KEYMAP_SECTION_ENABLE
             " KEYMAP_SECTION"
+#endif
+#ifdef LATENCY_TRACE_ENABLE
+            " LATENCY_TRACE"
+#endif
+#ifdef LAYER_CACHE_ENABLE
+            " LAYER_CACHE"
+#endif
+#ifdef REPORT_INDEX_ENABLE
+            " REPORT_INDEX"
+#endif
+#ifdef TLOG_ENABLE
+            " TLOG"
+#endif
+#ifdef IDLE_SLEEP_ENABLE
+            " IDLE_SLEEP"
+#endif
+#ifdef MATRIX_WAKE_ENABLE
+            " MATRIX_WAKE"
+#endif
+#ifdef SOF_SCAN_PHASE
+            " SOF_SCAN"
+#endif
+#ifdef REPORT_QUEUE_SIZE
+            " REPORT_QUEUE"
+#endif
+#ifdef REPORT_COALESCE_MS
+            " REPORT_COALESCE"
+#endif
+#ifdef TAPPING_CONFIG_ENABLE
+            " TAPPING_CONFIG"
+#endif
+#if defined(DEBOUNCE_EAGER_KEY)
+            " DEBOUNCE_EAGER_KEY"
+#elif defined(DEBOUNCE_DEFER_ROW)
+            " DEBOUNCE_DEFER_ROW"
+#else
+            " DEBOUNCE_SYM_GLOBAL"
 #endif
             " " STR(BOOTLOADER_SIZE) "\n");
+            console_yield();
 
             print("GCC: " STR(__GNUC__) "." STR(__GNUC_MINOR__) "." STR(__GNUC_PATCHLEVEL__)
 #if defined(__AVR__)
@@ -333,10 +400,13 @@ static bool command_common(uint8_t code)
 #elif defined(__arm__)
             // TODO
             );
+#else
+                  "\n");
 #endif
+            console_yield();
             break;
         case KC_S:
-            print("\n\t- Status -\n");
+            print_yield("\n\t- Status -\n");
             print_val_hex8(host_keyboard_leds());
             print_val_hex8(keyboard_protocol);
             print_val_hex8(keyboard_idle);
@@ -344,6 +414,7 @@ static bool command_common(uint8_t code)
             print_val_hex8(keyboard_nkro);
 #endif
             print_val_hex32(timer_read32());
+            console_yield();
 
 #ifdef PROTOCOL_PJRC
             print_val_hex8(UDCON);
@@ -351,12 +422,48 @@ static bool command_common(uint8_t code)
             print_val_hex8(UDINT);
             print_val_hex8(usb_keyboard_leds);
             print_val_hex8(usb_keyboard_idle_count);
+            console_yield();
 #endif
 
 #ifdef PROTOCOL_PJRC
 #   if USB_COUNT_SOF
             print_val_hex8(usbSofCount);
 #   endif
+#endif
+
+#if defined(PROTOCOL_LUFA) && defined(REPORT_QUEUE_SIZE)
+            // queue stats start over from here
+            for (uint8_t i = 0; i < REPORT_QUEUE_NUM; i++) {
+                const report_queue_stat_t *q = lufa_report_queue_stat(i);
+                xprintf("report_queue[%u]: depth:%u max:%u merge:%u drop:%u\n", i, q->depth, q->max, q->merge, q->drop);
+                console_yield();
+            }
+            lufa_report_queue_clear_stat();
+#endif
+
+#ifdef SOF_SCAN_PHASE
+            xprintf("sof_scan: phase:%u frames:%u missed:%u scan_max:%u\n", SOF_SCAN_PHASE,
+                    sof_scan_stat()->frames, sof_scan_stat()->missed, sof_scan_stat()->scan_max);
+            sof_scan_clear_stat();
+            console_yield();
+#endif
+
+#ifdef IDLE_SLEEP_ENABLE
+            xprintf("idle_sleep: duty:%u/1000 sleeps:%u busy_max:%u\n",
+                    idle_sleep_stat()->duty, idle_sleep_stat()->sleeps, idle_sleep_stat()->busy_max);
+            idle_sleep_clear_stat();
+            console_yield();
+#endif
+
+#ifdef TLOG_ENABLE
+            xprintf("tlog: dropped:%u\n", tlog_dropped());
+            console_yield();
+#endif
+
+#if defined(CONSOLE_ENABLE) && (defined(PROTOCOL_LUFA) || defined(PROTOCOL_CHIBIOS) || defined(PLATFORM_HOST))
+            // bytes lost while this is printed are counted from now
+            xprintf("console_lost: %u\n", console_lost());
+            console_clear_lost();
 #endif
             break;
 #if defined(NKRO_ENABLE) || defined(NKRO_6KRO_ENABLE)
@@ -0,0 +1,69 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <stdint.h>
+
+
+/*
+ * Console output
+ *
+ * sendchar() of protocol driver puts bytes into buffer and never waits for
+ * host, the buffer is sent from main loop. When it is full bytes are lost
+ * by policy defined in config.h:
+ *
+ * (default)
+ *      New bytes are dropped.
+ * CONSOLE_DROP_OLDEST
+ *      Oldest bytes in buffer are dropped for new ones. LUFA only.
+ * CONSOLE_LOST_MARKER
+ *      New bytes are dropped and "[lost:N]" with count in hex is put in
+ *      place of them when buffer has room again.
+ *
+ * LUFA and ChibiOS.
+ *
+ * Long output from main loop like help of command calls console_yield()
+ * after each line so that driver can send buffer before next line. It waits
+ * only a few frames for host and returns at once when host doesn't read.
+ */
+
+/* bytes of "\n[lost:XXXX]\n" */
+#define CONSOLE_LOST_MARKER_SIZE    13
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* bytes lost since last clear, saturates at 0xFFFF */
+uint16_t console_lost(void);
+void console_clear_lost(void);
+
+#if defined(CONSOLE_ENABLE) && (defined(PROTOCOL_LUFA) || defined(PLATFORM_HOST))
+void console_yield(void);
+#else
+static inline void console_yield(void) {}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+/* count in hex which is cheap to make with interrupt off */
+static inline void console_lost_marker(uint8_t buf[CONSOLE_LOST_MARKER_SIZE], uint16_t n)
+{
+    static const char hex[16] = "0123456789ABCDEF";
+    buf[0] = '\n';
+    buf[1] = '[';
+    buf[2] = 'l';
+    buf[3] = 'o';
+    buf[4] = 's';
+    buf[5] = 't';
+    buf[6] = ':';
+    buf[7] = hex[(n >> 12) & 0xF];
+    buf[8] = hex[(n >> 8) & 0xF];
+    buf[9] = hex[(n >> 4) & 0xF];
+    buf[10] = hex[n & 0xF];
+    buf[11] = ']';
+    buf[12] = '\n';
+}
+
+#endif
@@ -0,0 +1,173 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "timer.h"
+#include "debug.h"
+#include "matrix.h"
+
+
+/*
+ * Debounce
+ *
+ * matrix_debounce() takes rows read from switches and updates debounced
+ * matrix state. Define one of these in config.h to select algorithm.
+ *
+ * DEBOUNCE_SYM_GLOBAL(default)
+ *      Any change on matrix restarts timer and whole matrix is updated when
+ *      no change is seen for DEBOUNCE ms. Both press and release are delayed.
+ * DEBOUNCE_DEFER_ROW
+ *      Same as above but timer is kept for each row. Chatter on a row doesn't
+ *      hold back changes on other rows.
+ * DEBOUNCE_EAGER_KEY
+ *      Change of a key is reported at once and then the key is ignored for
+ *      DEBOUNCE ms. Chatter after press/release is rejected with no delay.
+ *      State at end of the period is taken on next scan if it differs.
+ *      Not for switches with noise on idle state.
+ *
+ * DEBOUNCE is time in ms, 0 to disable. Up to 255.
+ */
+#ifndef DEBOUNCE
+#   define DEBOUNCE 5
+#endif
+
+#if (DEBOUNCE > 255)
+#   error "DEBOUNCE must not exceed 255"
+#endif
+
+
+static inline void row_update(matrix_row_t matrix[], uint8_t row, matrix_row_t cols)
+{
+    matrix[row] = cols;
+#ifdef MATRIX_DIRTY_ROWS
+    matrix_set_dirty(row);
+#endif
+}
+
+#if (DEBOUNCE == 0)
+
+__attribute__ ((weak))
+bool matrix_debounce(matrix_row_t matrix[], const matrix_row_t raw[])
+{
+    bool changed = false;
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        if (matrix[i] != raw[i]) {
+            row_update(matrix, i, raw[i]);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+#elif defined(DEBOUNCE_EAGER_KEY)
+
+/* remaining ms of each key and keys with the count running */
+static uint8_t counter[MATRIX_ROWS][MATRIX_COLS];
+static matrix_row_t counting[MATRIX_ROWS];
+static uint16_t last_time = 0;
+
+__attribute__ ((weak))
+bool matrix_debounce(matrix_row_t matrix[], const matrix_row_t raw[])
+{
+    bool changed = false;
+    uint16_t elapsed = timer_elapsed(last_time);
+    if (elapsed) last_time += elapsed;
+
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        if (counting[i] && elapsed) {
+            uint8_t *c = counter[i];
+            for (matrix_row_t bits = counting[i], m = 1; bits; bits >>= 1, m <<= 1, c++) {
+                if (!(bits & 1)) continue;
+                if (*c > elapsed) {
+                    *c -= elapsed;
+                } else {
+                    *c = 0;
+                    counting[i] &= ~m;
+                }
+            }
+        }
+
+        matrix_row_t accept = (matrix[i] ^ raw[i]) & ~counting[i];
+        if (!accept) continue;
+
+        uint8_t *c = counter[i];
+        for (matrix_row_t bits = accept; bits; bits >>= 1, c++) {
+            if (bits & 1) *c = DEBOUNCE;
+        }
+        counting[i] |= accept;
+        row_update(matrix, i, matrix[i] ^ accept);
+        changed = true;
+    }
+    return changed;
+}
+
+#elif defined(DEBOUNCE_DEFER_ROW)
+
+/* remaining ms of each row, 0 when settled */
+static uint8_t counter[MATRIX_ROWS];
+static matrix_row_t debouncing[MATRIX_ROWS];
+static uint16_t last_time = 0;
+
+__attribute__ ((weak))
+bool matrix_debounce(matrix_row_t matrix[], const matrix_row_t raw[])
+{
+    bool changed = false;
+    uint16_t elapsed = timer_elapsed(last_time);
+    if (elapsed) last_time += elapsed;
+
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        if (debouncing[i] != raw[i]) {
+            if (counter[i]) {
+                dprintf("bounce: %d@%02X\n", i, debouncing[i]^raw[i]);
+            }
+            debouncing[i] = raw[i];
+            counter[i] = DEBOUNCE;
+            continue;
+        }
+        if (!counter[i]) continue;
+
+        if (counter[i] > elapsed) {
+            counter[i] -= elapsed;
+            continue;
+        }
+        counter[i] = 0;
+        if (matrix[i] != debouncing[i]) {
+            row_update(matrix, i, debouncing[i]);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+#else   /* DEBOUNCE_SYM_GLOBAL */
+
+static bool debouncing_flag = false;
+static uint16_t debouncing_time = 0;
+static matrix_row_t debouncing[MATRIX_ROWS];
+
+__attribute__ ((weak))
+bool matrix_debounce(matrix_row_t matrix[], const matrix_row_t raw[])
+{
+    bool changed = false;
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        if (debouncing[i] != raw[i]) {
+            if (debouncing_flag) {
+                dprintf("bounce: %d %d@%02X\n", timer_elapsed(debouncing_time), i, debouncing[i]^raw[i]);
+            }
+            debouncing[i] = raw[i];
+            debouncing_flag = true;
+            debouncing_time = timer_read();
+        }
+    }
+
+    if (debouncing_flag && timer_elapsed(debouncing_time) >= DEBOUNCE) {
+        for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+            if (matrix[i] != debouncing[i]) {
+                row_update(matrix, i, debouncing[i]);
+                changed = true;
+            }
+        }
+        debouncing_flag = false;
+    }
+    return changed;
+}
+
+#endif
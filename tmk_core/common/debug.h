@@ -20,6 +20,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <stdbool.h>
 #include "print.h"
+#ifdef TLOG_ENABLE
+#   include "tlog.h"
+#endif
 
 
 #ifdef __cplusplus
@@ -58,6 +61,35 @@ extern debug_config_t debug_config;
  */
 #ifndef NO_DEBUG
 
+#ifdef TLOG_ENABLE
+/* tokenized and sent later from keyboard_task(), argument must be literal */
+#define dprint(s)                   do { if (debug_enable) tlog(s); } while (0)
+#define dprintln(s)                 do { if (debug_enable) tlog(s "\r\n"); } while (0)
+#define dprintf(fmt, ...)           do { if (debug_enable) tlog(fmt, ##__VA_ARGS__); } while (0)
+#define dmsg(s)                     dprintf("%s at %d: %S\n", __FILE__, __LINE__, PSTR(s))
+
+/* Deprecated. DO NOT USE these anymore, use dprintf instead. */
+#define debug(s)                    dprint(s)
+#define debugln(s)                  dprintln(s)
+#define debug_msg(s)                do { \
+    if (debug_enable) { \
+        print(__FILE__); print(" at "); print_dec(__LINE__); print(" in "); print(": "); print(s); \
+    } \
+} while (0)
+#define debug_dec(data)             dprintf("%u", data)
+#define debug_decs(data)            dprintf("%d", data)
+#define debug_hex4(data)            dprintf("%X", data)
+#define debug_hex8(data)            dprintf("%02X", data)
+#define debug_hex16(data)           dprintf("%04X", data)
+#define debug_hex32(data)           dprintf("%08lX", data)
+#define debug_bin8(data)            dprintf("%08b", data)
+#define debug_bin16(data)           dprintf("%016b", data)
+#define debug_bin32(data)           dprintf("%032lb", data)
+#define debug_bin_reverse8(data)    dprintf("%08b", bitrev(data))
+#define debug_bin_reverse16(data)   dprintf("%016b", bitrev16(data))
+#define debug_bin_reverse32(data)   dprintf("%032lb", bitrev32(data))
+
+#else
 #define dprint(s)                   do { if (debug_enable) print(s); } while (0)
 #define dprintln(s)                 do { if (debug_enable) println(s); } while (0)
 #define dprintf(fmt, ...)           do { if (debug_enable) xprintf(fmt, ##__VA_ARGS__); } while (0)
@@ -83,6 +115,7 @@ extern debug_config_t debug_config;
 #define debug_bin_reverse8(data)    do { if (debug_enable) print_bin_reverse8(data); } while (0)
 #define debug_bin_reverse16(data)   do { if (debug_enable) print_bin_reverse16(data); } while (0)
 #define debug_bin_reverse32(data)   do { if (debug_enable) print_bin_reverse32(data); } while (0)
+#endif
 #define debug_hex(data)             debug_hex8(data)
 #define debug_bin(data)             debug_bin8(data)
 #define debug_bin_reverse(data)     debug_bin8(data)
@@ -16,11 +16,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include <stdint.h>
+#include <string.h>
 //#include <avr/interrupt.h>
 #include "keycode.h"
 #include "host.h"
+#include "timer.h"
 #include "util.h"
 #include "debug.h"
+#include "latency_trace.h"
 
 #include "mouse.h"
 #ifdef MOUSEKEY_ENABLE
@@ -33,8 +36,31 @@ bool keyboard_nkro = true;
 #endif
 
 static host_driver_t *driver;
+static report_keyboard_t last_keyboard_report = {};
+static report_mouse_t last_mouse_report = {};
 static uint16_t last_system_report = 0;
 static uint16_t last_consumer_report = 0;
+static uint16_t keyboard_sent_time = 0;
+
+/*
+ * Report coalescing
+ *
+ * Define REPORT_COALESCE_MS in config.h to send keyboard and mouse report at
+ * most once in the period, which is USB polling interval usually. A report
+ * sent within the period is held and replaced by following reports, then
+ * sent by host_task() at end of the period. Held keyboard report is sent at
+ * once instead of being replaced when a key pressed in it is released, a key
+ * released in it is pressed again or modifiers change after a key press, so
+ * that no stroke is lost. Movement of mouse reports is added up only while
+ * buttons are same.
+ */
+#ifdef REPORT_COALESCE_MS
+static report_keyboard_t held_keyboard_report;
+static bool keyboard_held = false;
+static report_mouse_t held_mouse_report;
+static bool mouse_held = false;
+static uint16_t mouse_sent_time = 0;
+#endif
 
 
 void host_set_driver(host_driver_t *d)
@@ -52,24 +78,126 @@ uint8_t host_keyboard_leds(void)
     if (!driver) return 0;
     return (*driver->keyboard_leds)();
 }
+
+uint8_t host_keyboard_pending(void)
+{
+    if (!driver) return 0;
+    uint8_t pending;
+    if (driver->keyboard_pending) {
+        pending = (*driver->keyboard_pending)();
+    } else {
+        // driver doesn't tell: report is pending in the ms it is sent, so
+        // that one is sent per ms at most
+        pending = (timer_elapsed(keyboard_sent_time) == 0);
+    }
+#ifdef REPORT_COALESCE_MS
+    if (keyboard_held) pending++;
+#endif
+    return pending;
+}
+void host_reports_lost(void)
+{
+    // no real report matches
+    memset(&last_keyboard_report, 0xFF, sizeof(last_keyboard_report));
+    last_mouse_report.buttons = 0xFF;
+}
+
 /* send report */
-void host_keyboard_send(report_keyboard_t *report)
+static void driver_send_keyboard(report_keyboard_t *report)
 {
-    if (!driver) return;
+    last_keyboard_report = *report;
+    keyboard_sent_time = timer_read();
     (*driver->send_keyboard)(report);
 
     if (debug_keyboard) {
         dprint("keyboard: ");
-        for (uint8_t i = 0; i < KEYBOARD_REPORT_SIZE; i++) {
-            dprintf("%02X ", report->raw[i]);
+        // eight bytes per call, size of report is multiple of 8
+        for (uint8_t i = 0; i < KEYBOARD_REPORT_SIZE; i += 8) {
+            dprintf("%02X %02X %02X %02X %02X %02X %02X %02X ",
+                    report->raw[i],   report->raw[i+1], report->raw[i+2], report->raw[i+3],
+                    report->raw[i+4], report->raw[i+5], report->raw[i+6], report->raw[i+7]);
         }
         dprint("\n");
     }
 }
 
-void host_mouse_send(report_mouse_t *report)
+#if defined(REPORT_COALESCE_MS) || defined(REPORT_QUEUE_SIZE)
+bool host_keyboard_has_key(report_keyboard_t *report, uint8_t code)
+{
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (report->keys[i] == code) return true;
+    }
+    return false;
+}
+
+/* whether report b can replace held report a, with report l sent last
+ * Also modifiers can't change after a key is pressed in a, since the key
+ * would be sent with modifiers of b. */
+bool host_keyboard_mergeable(report_keyboard_t *l, report_keyboard_t *a, report_keyboard_t *b)
+{
+    if ((a->mods & ~l->mods & ~b->mods) || (l->mods & ~a->mods & b->mods)) {
+        return false;
+    }
+    bool mods_change = (a->mods != b->mods);
+#if defined(NKRO_ENABLE) || defined(NKRO_6KRO_ENABLE)
+    if (keyboard_protocol && keyboard_nkro) {
+        for (uint8_t i = 0; i < KEYBOARD_REPORT_BITS; i++) {
+            uint8_t pressed = a->nkro.bits[i] & ~l->nkro.bits[i];
+            if ((pressed & ~b->nkro.bits[i]) || (pressed && mods_change) ||
+                (l->nkro.bits[i] & ~a->nkro.bits[i] & b->nkro.bits[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+#endif
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        uint8_t code = a->keys[i];
+        if (code && !host_keyboard_has_key(l, code) &&
+                (mods_change || !host_keyboard_has_key(b, code))) {
+            return false;
+        }
+        code = l->keys[i];
+        if (code && !host_keyboard_has_key(a, code) && host_keyboard_has_key(b, code)) {
+            return false;
+        }
+    }
+    return true;
+}
+#endif
+
+void host_keyboard_send(report_keyboard_t *report)
 {
     if (!driver) return;
+    LATENCY_TRACE(LATENCY_TRACE_HOST_SEND);
+
+#ifdef REPORT_COALESCE_MS
+    if (keyboard_held) {
+        if (host_keyboard_mergeable(&last_keyboard_report, &held_keyboard_report, report)) {
+            held_keyboard_report = *report;
+            return;
+        }
+        keyboard_held = false;
+        driver_send_keyboard(&held_keyboard_report);
+    }
+#endif
+    if (!memcmp(report, &last_keyboard_report, sizeof(report_keyboard_t))) return;
+#ifdef REPORT_COALESCE_MS
+    if (timer_elapsed(keyboard_sent_time) < REPORT_COALESCE_MS) {
+        held_keyboard_report = *report;
+        keyboard_held = true;
+        return;
+    }
+#endif
+    driver_send_keyboard(report);
+}
+
+static void driver_send_mouse(report_mouse_t *report)
+{
+    last_mouse_report = *report;
+#ifdef REPORT_COALESCE_MS
+    mouse_sent_time = timer_read();
+#endif
 #ifdef MOUSE_EXT_REPORT
     // clip and copy to Boot protocol XY
     report->boot_x = (report->x > 127) ? 127 : ((report->x < -127) ? -127 : report->x);
@@ -83,6 +211,58 @@ void host_mouse_send(report_mouse_t *report)
     }
 }
 
+#ifdef REPORT_COALESCE_MS
+#ifndef MOUSE_EXT_REPORT
+#   define MOUSE_XY_MAX     127
+#else
+#   define MOUSE_XY_MAX     32767
+#endif
+static inline bool mouse_add(int16_t a, int16_t b, int16_t max)
+{
+    return (a + b <= max && a + b >= -max);
+}
+
+/* movement of b can be added to held report a when buttons are same */
+static bool mouse_mergeable(report_mouse_t *a, report_mouse_t *b)
+{
+    return (a->buttons == b->buttons &&
+            mouse_add(a->x, b->x, MOUSE_XY_MAX) && mouse_add(a->y, b->y, MOUSE_XY_MAX) &&
+            mouse_add(a->v, b->v, 127) && mouse_add(a->h, b->h, 127));
+}
+#endif
+
+void host_mouse_send(report_mouse_t *report)
+{
+    if (!driver) return;
+
+#ifdef REPORT_COALESCE_MS
+    if (mouse_held) {
+        if (mouse_mergeable(&held_mouse_report, report)) {
+            held_mouse_report.x += report->x;
+            held_mouse_report.y += report->y;
+            held_mouse_report.v += report->v;
+            held_mouse_report.h += report->h;
+            return;
+        }
+        mouse_held = false;
+        driver_send_mouse(&held_mouse_report);
+    }
+#endif
+    // no movement and no change of buttons
+    if (report->buttons == last_mouse_report.buttons &&
+            !report->x && !report->y && !report->v && !report->h) {
+        return;
+    }
+#ifdef REPORT_COALESCE_MS
+    if (timer_elapsed(mouse_sent_time) < REPORT_COALESCE_MS) {
+        held_mouse_report = *report;
+        mouse_held = true;
+        return;
+    }
+#endif
+    driver_send_mouse(report);
+}
+
 void host_system_send(uint16_t report)
 {
     if (report == last_system_report) return;
@@ -109,6 +289,22 @@ void host_consumer_send(uint16_t report)
     }
 }
 
+/* send reports held for coalescing when the period is over */
+void host_task(void)
+{
+#ifdef REPORT_COALESCE_MS
+    if (!driver) return;
+    if (keyboard_held && timer_elapsed(keyboard_sent_time) >= REPORT_COALESCE_MS) {
+        keyboard_held = false;
+        driver_send_keyboard(&held_keyboard_report);
+    }
+    if (mouse_held && timer_elapsed(mouse_sent_time) >= REPORT_COALESCE_MS) {
+        mouse_held = false;
+        driver_send_mouse(&held_mouse_report);
+    }
+#endif
+}
+
 uint16_t host_last_system_report(void)
 {
     return last_system_report;
@@ -49,10 +49,25 @@ void host_keyboard_send(report_keyboard_t *report);
 void host_mouse_send(report_mouse_t *report);
 void host_system_send(uint16_t data);
 void host_consumer_send(uint16_t data);
+/* send held reports(REPORT_COALESCE_MS) */
+void host_task(void);
+/* keyboard reports held or queued in driver, 0 when host has taken all */
+uint8_t host_keyboard_pending(void);
+/* driver couldn't send last report or host state is reset, e.g. on USB reset
+ * or protocol change: next keyboard and mouse reports are sent even if same */
+void host_reports_lost(void);
 
 uint16_t host_last_system_report(void);
 uint16_t host_last_consumer_report(void);
 
+#if defined(REPORT_COALESCE_MS) || defined(REPORT_QUEUE_SIZE)
+/* whether report b can replace a without losing press or release of key
+ * when l is the report host got before a */
+bool host_keyboard_mergeable(report_keyboard_t *l, report_keyboard_t *a, report_keyboard_t *b);
+/* whether key is in keys[] of 6KRO report */
+bool host_keyboard_has_key(report_keyboard_t *report, uint8_t code);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,65 @@
+#include <stdint.h>
+#include "timer.h"
+
+/* Mill second tick count */
+volatile uint32_t timer_count = 0;
+
+/* sub-millisecond part of fake clock in microseconds */
+static uint16_t timer_us = 0;
+
+
+void timer_init(void)
+{
+    timer_count = 0;
+    timer_us = 0;
+}
+
+void timer_clear(void)
+{
+    timer_count = 0;
+    timer_us = 0;
+}
+
+uint16_t timer_read(void)
+{
+    return (uint16_t)(timer_count & 0xFFFF);
+}
+
+uint32_t timer_read32(void)
+{
+    return timer_count;
+}
+
+uint16_t timer_elapsed(uint16_t last)
+{
+    return TIMER_DIFF_16(timer_read(), last);
+}
+
+uint32_t timer_elapsed32(uint32_t last)
+{
+    return TIMER_DIFF_32(timer_read32(), last);
+}
+
+
+void timer_host_set(uint32_t ms)
+{
+    timer_count = ms;
+    timer_us = 0;
+}
+
+void timer_host_advance(uint32_t ms)
+{
+    timer_count += ms;
+}
+
+void timer_host_advance_us(uint32_t us)
+{
+    us += timer_us;
+    timer_count += us / 1000;
+    timer_us = us % 1000;
+}
+
+uint32_t timer_host_read_us(void)
+{
+    return timer_count * 1000 + timer_us;
+}
@@ -0,0 +1,26 @@
+
+#ifndef TIMER_HOST_H
+#define TIMER_HOST_H 1
+
+#include <stdint.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Fake clock of host build
+ *
+ * No interrupt drives the clock. The harness moves time forward explicitly
+ * so that replay of an event stream is deterministic.
+ */
+void timer_host_set(uint32_t ms);
+void timer_host_advance(uint32_t ms);
+void timer_host_advance_us(uint32_t us);
+uint32_t timer_host_read_us(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,99 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include "host/xprintf.h"
+
+
+static void xputc_stderr(uint8_t c)
+{
+    fputc(c, stderr);
+}
+
+void (*xfunc_out)(uint8_t) = xputc_stderr;
+
+
+void xputc(char c)
+{
+    if (xfunc_out) xfunc_out((uint8_t)c);
+}
+
+void xputs(const char *s)
+{
+    while (*s) xputc(*s++);
+}
+
+int xprintf(const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    char c;
+    int n = 0;
+    while ((c = *fmt++)) {
+        if (c != '%') {
+            xputc(c); n++;
+            continue;
+        }
+
+        char pad = ' ';
+        uint8_t width = 0;
+        uint8_t is_long = 0;
+        c = *fmt++;
+        if (c == '0') { pad = '0'; c = *fmt++; }
+        while (c >= '0' && c <= '9') { width = width * 10 + (c - '0'); c = *fmt++; }
+        if (c == 'l') { is_long = 1; c = *fmt++; }
+        if (!c) break;
+
+        uint8_t radix = 0;
+        uint8_t is_signed = 0;
+        switch (c) {
+            case 'c':
+                xputc((char)va_arg(ap, int)); n++;
+                continue;
+            case 's':
+            case 'S': {
+                const char *s = va_arg(ap, const char *);
+                uint8_t len = 0;
+                for (const char *p = s; *p; p++) len++;
+                while (len < width--) { xputc(' '); n++; }
+                while (*s) { xputc(*s++); n++; }
+                continue;
+            }
+            case 'b': radix = 2; break;
+            case 'o': radix = 8; break;
+            case 'd': radix = 10; is_signed = 1; break;
+            case 'u': radix = 10; break;
+            case 'x':
+            case 'X': radix = 16; break;
+            default:
+                xputc(c); n++;
+                continue;
+        }
+
+        /* truncate to AVR width of int and long */
+        uint32_t v;
+        uint8_t neg = 0;
+        if (is_long) {
+            v = (uint32_t)va_arg(ap, unsigned long);
+            if (is_signed && (int32_t)v < 0) { neg = 1; v = -(int32_t)v; }
+        } else {
+            v = (uint16_t)va_arg(ap, unsigned int);
+            if (is_signed && (int16_t)v < 0) { neg = 1; v = (uint16_t)-(int16_t)v; }
+        }
+
+        char a = (c == 'x') ? 'a' : 'A';
+        char buf[33];
+        uint8_t i = 0;
+        do {
+            uint8_t d = v % radix;
+            buf[i++] = d < 10 ? '0' + d : a + d - 10;
+            v /= radix;
+        } while (v);
+        if (neg) {
+            if (pad == '0') { xputc('-'); n++; if (width) width--; }
+            else buf[i++] = '-';
+        }
+        while (i < width--) { xputc(pad); n++; }
+        while (i) { xputc(buf[--i]); n++; }
+    }
+    va_end(ap);
+    return n;
+}
@@ -0,0 +1,25 @@
+#ifndef XPRINTF_H
+#define XPRINTF_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern void (*xfunc_out)(uint8_t);
+#define xdev_out(func) xfunc_out = (void(*)(uint8_t))(func)
+
+/* Same format as avr/xprintf.S so that debug output reads identically.
+ * int is treated as 16-bit and long as 32-bit like AVR. %b is binary and
+ * %S is same as %s since no program space exists on host. */
+void xputc(char chr);
+void xputs(const char *string);
+int xprintf(const char *format, ...);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
@@ -28,6 +28,8 @@ typedef struct {
     void (*send_mouse)(report_mouse_t *);
     void (*send_system)(uint16_t);
     void (*send_consumer)(uint16_t);
+    /* keyboard reports queued and not yet taken by host, optional */
+    uint8_t (*keyboard_pending)(void);
 } host_driver_t;
 
 #endif
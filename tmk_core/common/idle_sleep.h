@@ -0,0 +1,43 @@
+#ifndef IDLE_SLEEP_H
+#define IDLE_SLEEP_H
+
+#include <stdint.h>
+
+
+/*
+ * Idle sleep
+ *
+ * Main loop calls idle_sleep_task() after its tasks. When no key is down
+ * for IDLE_SLEEP_DELAY ms MCU goes into idle sleep there until next
+ * interrupt, Timer0 tick every 1ms or pin change, so that keyboard is
+ * scanned once per wakeup instead of running loop at full rate. Key down
+ * resumes full rate at once.
+ *
+ * Duty is time awake out of 1000 since stats cleared, busy_max is the
+ * longest run of main loop between sleeps. AVR only.
+ */
+#ifndef IDLE_SLEEP_DELAY
+#define IDLE_SLEEP_DELAY    50
+#endif
+
+typedef struct {
+    uint16_t duty;          /* awake per mille */
+    uint16_t sleeps;        /* times slept */
+    uint16_t busy_max;      /* us awake between sleeps */
+} idle_sleep_stat_t;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void idle_sleep_task(void);
+
+const idle_sleep_stat_t *idle_sleep_stat(void);
+void idle_sleep_clear_stat(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
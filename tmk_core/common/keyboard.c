@@ -31,12 +31,20 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "eeconfig.h"
 #include "backlight.h"
 #include "hook.h"
+#include "latency_trace.h"
+#include "action_macro.h"
 #ifdef MOUSEKEY_ENABLE
 #   include "mousekey.h"
 #endif
 #ifdef PS2_MOUSE_ENABLE
 #   include "ps2_mouse.h"
 #endif
+#ifdef TLOG_ENABLE
+#   include "tlog.h"
+#endif
+#ifdef MATRIX_WAKE_ENABLE
+#   include "matrix_wake.h"
+#endif
 #ifdef SERIAL_MOUSE_ENABLE
 #include "serial_mouse.h"
 #endif
@@ -101,13 +109,30 @@ void keyboard_task(void)
     static matrix_row_t matrix_prev[MATRIX_ROWS];
 #ifdef MATRIX_HAS_GHOST
     static matrix_row_t matrix_ghost[MATRIX_ROWS];
+#endif
+#ifdef MATRIX_DIRTY_ROWS
+    // rows to look into again on next call
+    static matrix_dirty_t matrix_pending = 0;
 #endif
     static uint8_t led_status = 0;
     matrix_row_t matrix_row = 0;
     matrix_row_t matrix_change = 0;
 
+    LATENCY_TRACE_SCAN();
+#ifdef MATRIX_WAKE_ENABLE
+    // no scan while matrix waits for key down
+    if (matrix_wake_task())
+#endif
     matrix_scan();
+#ifdef MATRIX_DIRTY_ROWS
+    // skip rows not modified
+    matrix_dirty_t dirty = matrix_get_dirty() | matrix_pending;
+    matrix_pending = 0;
+    for (uint8_t r = 0; dirty; r++, dirty >>= 1) {
+        if (!(dirty & 1)) continue;
+#else
     for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+#endif
         matrix_row = matrix_get_row(r);
         matrix_change = matrix_row ^ matrix_prev[r];
         if (matrix_change) {
@@ -121,6 +146,9 @@ void keyboard_task(void)
                     matrix_print();
                 }
                 matrix_ghost[r] = matrix_row;
+#ifdef MATRIX_DIRTY_ROWS
+                matrix_pending |= ((matrix_dirty_t)1<<r);
+#endif
                 continue;
             }
             matrix_ghost[r] = matrix_row;
@@ -134,8 +162,25 @@ void keyboard_task(void)
                         .pressed = (matrix_row & col_mask),
                         .time = (timer_read() | 1) /* time should not be 0 */
                     };
+#ifndef NO_ACTION_MACRO
+                    // key event waits in line while macro is played
+                    if (action_macro_playing()) {
+                        if (!action_macro_hold(e)) {
+                            // no room, look at it again on next scan
+#ifdef MATRIX_DIRTY_ROWS
+                            matrix_pending |= ((matrix_dirty_t)1<<r);
+#endif
+                            continue;
+                        }
+                        hook_matrix_change(e);
+                        matrix_prev[r] ^= col_mask;
+                        continue;
+                    }
+#endif
+                    LATENCY_TRACE_START();
                     action_exec(e);
                     hook_matrix_change(e);
+                    LATENCY_TRACE_END();
                     // record a processed key
                     matrix_prev[r] ^= col_mask;
 
@@ -147,7 +192,11 @@ void keyboard_task(void)
         }
     }
     // call with pseudo tick event when no real key event.
-    action_exec(TICK);
+    // not while events are held, tapping would time out ahead of them
+    if (!action_macro_playing()) {
+        action_exec(TICK);
+    }
+    action_macro_task();
 
 //MATRIX_LOOP_END:
 
@@ -170,12 +219,21 @@ void keyboard_task(void)
         adb_mouse_task();
 #endif
 
+#ifdef REPORT_COALESCE_MS
+    host_task();
+#endif
+
     // update LED
     if (led_status != host_keyboard_leds()) {
         led_status = host_keyboard_leds();
         if (debug_keyboard) dprintf("LED: %02X\n", led_status);
         hook_keyboard_leds_change(led_status);
     }
+
+#ifdef TLOG_ENABLE
+    // send out tokenized log
+    tlog_task();
+#endif
 }
 
 void keyboard_set_leds(uint8_t leds)
@@ -0,0 +1,36 @@
+#include <stdint.h>
+#include "progmem.h"
+#include "util.h"
+#include "keymap_compiled.h"
+
+/* tables generated by host build, see keymap_compiled.h */
+#include KEYMAP_COMPILED
+
+#if (KEYMAP_COMPILED_ROWS != MATRIX_ROWS || KEYMAP_COMPILED_COLS != MATRIX_COLS)
+#   error "KEYMAP_COMPILED doesn't match matrix of this project, make it again"
+#endif
+
+
+const uint8_t keymap_compiled_layers = KEYMAP_COMPILED_LAYERS;
+
+action_t keymap_compiled_action(uint8_t layer, keypos_t key)
+{
+    if (layer >= KEYMAP_COMPILED_LAYERS) {
+        return (action_t)ACTION_TRANSPARENT;
+    }
+    return (action_t)pgm_read_word(&keymap_compiled_actions[layer][key.row][key.col]);
+}
+
+uint8_t keymap_compiled_layer(uint32_t layers, keypos_t key)
+{
+    /* bitmap is as wide as number of layers needs */
+    const void *p = &keymap_compiled_opaque[key.row][key.col];
+    uint32_t opaque;
+    switch (sizeof(keymap_compiled_opaque[0][0])) {
+        case 1:  opaque = pgm_read_byte(p);  break;
+        case 2:  opaque = pgm_read_word(p);  break;
+        default: opaque = pgm_read_dword(p); break;
+    }
+    layers &= opaque;
+    return layers ? biton32(layers) : 0;
+}
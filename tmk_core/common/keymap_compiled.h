@@ -0,0 +1,47 @@
+#ifndef KEYMAP_COMPILED_H
+#define KEYMAP_COMPILED_H
+
+#include <stdint.h>
+#include "keyboard.h"
+#include "action.h"
+
+
+/*
+ * Compiled keymap
+ *
+ * Keymap resolved at build time into dense table of actions and bitmap of
+ * layers where each key is not transparent. Layer of key on any combination
+ * of layers is the top bit of the combination ANDed with the bitmap, then
+ * layer_switch_get_action() takes two table reads instead of calling
+ * action_for_key() layer by layer, which does keycode or unimap translation
+ * and Fn indirection each time.
+ *
+ * The table is made with host build of the project and given to firmware
+ * build with path of the file. Make it again after changing keymap.
+ *
+ *      $ make -f Makefile.host KEYMAP=<name>
+ *      $ obj_<project>_host/<project>_host -k 0 > keymap_<name>_compiled.h
+ *      $ make KEYMAP=<name> KEYMAP_COMPILED=keymap_<name>_compiled.h
+ *
+ * Layers after the top one reachable from layer 0 through layer actions of
+ * keymap are out of the table and transparent. Give number of layers with
+ * -k when layers are switched by action_function() or macro.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* number of layers in table */
+extern const uint8_t keymap_compiled_layers;
+
+/* same as action_for_key() */
+action_t keymap_compiled_action(uint8_t layer, keypos_t key);
+/* top layer of layers where key is not transparent, 0 if none */
+uint8_t keymap_compiled_layer(uint32_t layers, keypos_t key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,277 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "timer.h"
+#include "print.h"
+#include "util.h"
+#include "console.h"
+#include "latency_trace.h"
+#if defined(__AVR__)
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#endif
+
+
+/* tick frequency of latency_trace_now(), tool/host/latency_check gives AVR one */
+#if defined(LATENCY_TRACE_TICKS_PER_MS)
+#   define TICKS_PER_MS     LATENCY_TRACE_TICKS_PER_MS
+#elif defined(__AVR__)
+/* Timer0 CTC counts 0..TIMER_RAW_TOP */
+#   define TICKS_PER_MS     (TIMER_RAW_TOP + 1)
+#elif defined(PLATFORM_HOST)
+#   define TICKS_PER_MS     1000
+#else
+/* no raw counter: resolution is 1ms */
+#   define TICKS_PER_MS     1
+#endif
+
+
+/* padded to same width since xprintf has no left-justify */
+static const char *stage_name[LATENCY_TRACE_STAGES] = {
+    [LATENCY_TRACE_MATRIX_SCAN] = "scan",
+    [LATENCY_TRACE_ACTION_EXEC] = "exec",
+    [LATENCY_TRACE_TAPPING]     = "tap ",
+    [LATENCY_TRACE_ADD_KEY]     = "add ",
+    [LATENCY_TRACE_HOST_SEND]   = "send",
+    [LATENCY_TRACE_ENDPOINT]    = "ep  ",
+};
+
+static uint32_t scan_start = 0;
+static uint32_t start = 0;
+static bool tracing = false;
+static latency_record_t current;
+
+static latency_record_t records[LATENCY_TRACE_SIZE];
+static uint8_t records_head = 0;
+static uint8_t records_count = 0;
+/* records closed so far, sequence number of current record */
+static uint8_t records_seq = 0;
+
+static latency_stat_t stats[LATENCY_TRACE_STAGES];
+
+/* deferred stages: tag is index + 1 */
+typedef struct {
+    uint32_t start;
+    uint8_t seq;
+    uint8_t stage;
+    bool used;
+} pending_t;
+static pending_t pending[LATENCY_TRACE_PENDING];
+/* stages of current record deferred */
+static uint8_t deferred = 0;
+
+
+uint32_t latency_trace_now(void)
+{
+#if defined(__AVR__)
+    uint8_t sreg = SREG;
+    cli();
+    uint32_t ms = timer_count;
+    uint8_t raw = TIMER_RAW;
+    /* compare match occurred but timer_count is not updated yet */
+#   ifdef TIFR0
+    if (TIFR0 & (1<<OCF0A)) {
+#   else
+    if (TIFR & (1<<OCF0A)) {
+#   endif
+        ms++;
+        raw = TIMER_RAW;
+    }
+    SREG = sreg;
+    return ms * TICKS_PER_MS + raw;
+#elif defined(PLATFORM_HOST)
+    return timer_host_read_us();
+#else
+    return timer_read32();
+#endif
+}
+
+uint32_t latency_trace_ticks_to_us(uint32_t ticks)
+{
+    return ticks * 1000 / TICKS_PER_MS;
+}
+
+
+void latency_trace_scan(void)
+{
+    scan_start = latency_trace_now();
+}
+
+void latency_trace_start(void)
+{
+    for (uint8_t i = 0; i < LATENCY_TRACE_STAGES; i++) {
+        current.delta[i] = LATENCY_TRACE_NONE;
+    }
+    deferred = 0;
+    start = scan_start;
+    tracing = true;
+    latency_trace_mark(LATENCY_TRACE_MATRIX_SCAN);
+}
+
+void latency_trace_mark(uint8_t stage)
+{
+    if (!tracing) return;
+    if (current.delta[stage] != LATENCY_TRACE_NONE) return;
+    if (deferred & (1<<stage)) return;
+
+    uint32_t d = latency_trace_now() - start;
+    current.delta[stage] = (d < LATENCY_TRACE_NONE) ? d : LATENCY_TRACE_NONE - 1;
+}
+
+static void stat_add(uint8_t stage, uint16_t d)
+{
+    latency_stat_t *s = &stats[stage];
+    if (s->count == UINT16_MAX) return;     // saturated; clear to restart
+    if (s->count == 0 || d < s->min) s->min = d;
+    if (d > s->max) s->max = d;
+    s->sum += d;
+    s->count++;
+    s->hist[biton16(d)]++;
+}
+
+void latency_trace_end(void)
+{
+    if (!tracing) return;
+    tracing = false;
+
+    records[records_head] = current;
+    records_head = (records_head + 1) % LATENCY_TRACE_SIZE;
+    if (records_count < LATENCY_TRACE_SIZE) records_count++;
+    records_seq++;
+
+    for (uint8_t i = 0; i < LATENCY_TRACE_STAGES; i++) {
+        uint16_t d = current.delta[i];
+        if (d == LATENCY_TRACE_NONE) continue;
+        stat_add(i, d);
+    }
+}
+
+uint8_t latency_trace_defer(uint8_t stage)
+{
+    if (!tracing) return 0;
+    if (current.delta[stage] != LATENCY_TRACE_NONE) return 0;
+    if (deferred & (1<<stage)) return 0;
+
+    for (uint8_t i = 0; i < LATENCY_TRACE_PENDING; i++) {
+        if (pending[i].used) continue;
+        pending[i] = (pending_t){ .start = start, .seq = records_seq, .stage = stage, .used = true };
+        deferred |= (1<<stage);
+        return i + 1;
+    }
+    return 0;
+}
+
+void latency_trace_done(uint8_t tag)
+{
+    if (!tag) return;
+    pending_t *p = &pending[tag - 1];
+    if (!p->used) return;
+    p->used = false;
+
+    uint32_t t = latency_trace_now() - p->start;
+    uint16_t d = (t < LATENCY_TRACE_NONE) ? t : LATENCY_TRACE_NONE - 1;
+
+    if (tracing && p->seq == records_seq) {
+        /* record is still open, counted at latency_trace_end() */
+        deferred &= ~(1<<p->stage);
+        current.delta[p->stage] = d;
+        return;
+    }
+
+    /* fill in closed record if it is still kept */
+    uint8_t age = records_seq - p->seq;
+    if (age <= records_count) {
+        records[(records_head + LATENCY_TRACE_SIZE - age) % LATENCY_TRACE_SIZE].delta[p->stage] = d;
+    }
+    stat_add(p->stage, d);
+}
+
+void latency_trace_cancel(uint8_t tag)
+{
+    if (!tag) return;
+    pending_t *p = &pending[tag - 1];
+    if (p->used && tracing && p->seq == records_seq) {
+        deferred &= ~(1<<p->stage);
+    }
+    p->used = false;
+}
+
+
+void latency_trace_clear(void)
+{
+    tracing = false;
+    records_head = 0;
+    records_count = 0;
+    for (uint8_t i = 0; i < LATENCY_TRACE_PENDING; i++) {
+        /* closed records are gone, tags are still held by queue */
+        pending[i].seq = records_seq - LATENCY_TRACE_SIZE - 1;
+    }
+    for (uint8_t i = 0; i < LATENCY_TRACE_STAGES; i++) {
+        stats[i] = (latency_stat_t){};
+    }
+}
+
+const latency_stat_t *latency_trace_stat(uint8_t stage)
+{
+    return &stats[stage];
+}
+
+uint32_t latency_trace_percentile(const latency_stat_t *stat, uint8_t percent)
+{
+    if (!stat->count) return 0;
+
+    /* smallest bucket where cumulative count reaches the percentile */
+    uint32_t need = ((uint32_t)stat->count * percent + 99) / 100;
+    uint32_t sum = 0;
+    for (uint8_t b = 0; b < LATENCY_TRACE_BUCKETS; b++) {
+        sum += stat->hist[b];
+        if (sum >= need) {
+            /* upper bound of bucket, but not over observed max */
+            uint32_t upper = (2UL << b) - 1;
+            return (upper < stat->max) ? upper : stat->max;
+        }
+    }
+    return stat->max;
+}
+
+void latency_trace_print(void)
+{
+    print("\n\t- Latency(us) -\n");
+    print("stage  count   min   avg   max   p99\n");
+    console_yield();
+    for (uint8_t i = 0; i < LATENCY_TRACE_STAGES; i++) {
+        const latency_stat_t *s = &stats[i];
+        uint32_t avg = s->count ? s->sum / s->count : 0;
+        xprintf("%s %6u %5lu %5lu %5lu %5lu\n", stage_name[i], s->count,
+                latency_trace_ticks_to_us(s->min),
+                latency_trace_ticks_to_us(avg),
+                latency_trace_ticks_to_us(s->max),
+                latency_trace_ticks_to_us(latency_trace_percentile(s, 99)));
+        console_yield();
+    }
+
+    print("histogram(count per <us):\n");
+    for (uint8_t i = 0; i < LATENCY_TRACE_STAGES; i++) {
+        if (!stats[i].count) continue;
+        xprintf("%s", stage_name[i]);
+        for (uint8_t b = 0; b < LATENCY_TRACE_BUCKETS; b++) {
+            if (!stats[i].hist[b]) continue;
+            xprintf(" %lu:%u", latency_trace_ticks_to_us(2UL << b), stats[i].hist[b]);
+        }
+        print("\n");
+        console_yield();
+    }
+
+    print("recent:\n");
+    for (uint8_t n = 0; n < records_count; n++) {
+        uint8_t r = (records_head + LATENCY_TRACE_SIZE - records_count + n) % LATENCY_TRACE_SIZE;
+        for (uint8_t i = 0; i < LATENCY_TRACE_STAGES; i++) {
+            if (records[r].delta[i] == LATENCY_TRACE_NONE) {
+                print("     -");
+            } else {
+                xprintf(" %5lu", latency_trace_ticks_to_us(records[r].delta[i]));
+            }
+        }
+        print("\n");
+        console_yield();
+    }
+}
@@ -0,0 +1,111 @@
+#ifndef LATENCY_TRACE_H
+#define LATENCY_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*
+ * Latency trace
+ *
+ * Timestamps each stage a key event goes through from matrix scan to USB
+ * endpoint. A record is opened when keyboard_task() finds a matrix change
+ * and closed after the event is processed. Stages which are not reached
+ * during the record(e.g. key held back by tapping) are left out.
+ *
+ * Time is in ticks of timer raw counter; 4us on AVR at 16MHz.
+ */
+enum latency_trace_stage {
+    LATENCY_TRACE_MATRIX_SCAN = 0,  /* matrix_scan() finished */
+    LATENCY_TRACE_ACTION_EXEC,      /* action_exec() entered */
+    LATENCY_TRACE_TAPPING,          /* tapping decision made */
+    LATENCY_TRACE_ADD_KEY,          /* add_key() */
+    LATENCY_TRACE_HOST_SEND,        /* host_keyboard_send() */
+    LATENCY_TRACE_ENDPOINT,         /* report written to endpoint */
+    LATENCY_TRACE_STAGES
+};
+
+/* number of recent records kept for dump */
+#ifndef LATENCY_TRACE_SIZE
+#define LATENCY_TRACE_SIZE  8
+#endif
+
+/* histogram bucket n counts delta of [2^n, 2^(n+1)) ticks */
+#define LATENCY_TRACE_BUCKETS   16
+
+/* delta of stage not reached */
+#define LATENCY_TRACE_NONE      0xFFFF
+
+/* stages completed after record is closed, e.g. report queued for endpoint */
+#ifndef LATENCY_TRACE_PENDING
+#define LATENCY_TRACE_PENDING   4
+#endif
+
+
+#ifdef LATENCY_TRACE_ENABLE
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint16_t delta[LATENCY_TRACE_STAGES];
+} latency_record_t;
+
+typedef struct {
+    uint16_t min;
+    uint16_t max;
+    uint32_t sum;
+    uint16_t count;
+    uint16_t hist[LATENCY_TRACE_BUCKETS];
+} latency_stat_t;
+
+/* current time in ticks */
+uint32_t latency_trace_now(void);
+/* ticks to microseconds */
+uint32_t latency_trace_ticks_to_us(uint32_t ticks);
+
+void latency_trace_scan(void);
+void latency_trace_start(void);
+void latency_trace_mark(uint8_t stage);
+void latency_trace_end(void);
+
+/* Stage of current record is reached later: returns tag for
+ * latency_trace_done() or 0 when stage is not traced. Tag must be given back
+ * with latency_trace_done() or latency_trace_cancel(). */
+uint8_t latency_trace_defer(uint8_t stage);
+void latency_trace_done(uint8_t tag);
+void latency_trace_cancel(uint8_t tag);
+
+void latency_trace_clear(void);
+void latency_trace_print(void);
+
+/* percentile upper bound in ticks from histogram */
+uint32_t latency_trace_percentile(const latency_stat_t *stat, uint8_t percent);
+const latency_stat_t *latency_trace_stat(uint8_t stage);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define LATENCY_TRACE_SCAN()        latency_trace_scan()
+#define LATENCY_TRACE_START()       latency_trace_start()
+#define LATENCY_TRACE(stage)        latency_trace_mark(stage)
+#define LATENCY_TRACE_END()         latency_trace_end()
+#define LATENCY_TRACE_DEFER(stage)  latency_trace_defer(stage)
+#define LATENCY_TRACE_DONE(tag)     latency_trace_done(tag)
+#define LATENCY_TRACE_CANCEL(tag)   latency_trace_cancel(tag)
+
+#else
+
+#define LATENCY_TRACE_SCAN()        ((void)0)
+#define LATENCY_TRACE_START()       ((void)0)
+#define LATENCY_TRACE(stage)        ((void)0)
+#define LATENCY_TRACE_END()         ((void)0)
+#define LATENCY_TRACE_DEFER(stage)  0
+#define LATENCY_TRACE_DONE(tag)     ((void)0)
+#define LATENCY_TRACE_CANCEL(tag)   ((void)0)
+
+#endif
+
+#endif
@@ -91,5 +91,23 @@ bool matrix_has_ghost_in_row(uint8_t row)
 }
 #endif
 
+#ifdef MATRIX_DIRTY_ROWS
+static matrix_dirty_t matrix_dirty = 0;
+
+__attribute__ ((weak))
+void matrix_set_dirty(uint8_t row)
+{
+    matrix_dirty |= ((matrix_dirty_t)1<<row);
+}
+
+__attribute__ ((weak))
+matrix_dirty_t matrix_get_dirty(void)
+{
+    matrix_dirty_t dirty = matrix_dirty;
+    matrix_dirty = 0;
+    return dirty;
+}
+#endif
+
 __attribute__ ((weak)) void matrix_power_up(void) {}
 __attribute__ ((weak)) void matrix_power_down(void) {}
@@ -38,6 +38,23 @@ typedef  uint32_t   matrix_row_t;
 
 #define MATRIX_IS_ON(row, col)  (matrix_get_row(row) && (1<<col))
 
+/* Dirty rows(optional)
+ * Define MATRIX_DIRTY_ROWS in config.h when matrix.c calls matrix_set_dirty()
+ * on every row update. keyboard_task() then looks into only those rows
+ * instead of comparing all rows with previous state on every scan.
+ */
+#ifdef MATRIX_DIRTY_ROWS
+#   if (MATRIX_ROWS <= 8)
+typedef  uint8_t    matrix_dirty_t;
+#   elif (MATRIX_ROWS <= 16)
+typedef  uint16_t   matrix_dirty_t;
+#   elif (MATRIX_ROWS <= 32)
+typedef  uint32_t   matrix_dirty_t;
+#   else
+#       error "MATRIX_DIRTY_ROWS: MATRIX_ROWS must not exceed 32"
+#   endif
+#endif
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -68,6 +85,17 @@ void matrix_clear(void);
 bool matrix_has_ghost_in_row(uint8_t row);
 #endif
 
+#ifdef MATRIX_DIRTY_ROWS
+/* mark row modified */
+void matrix_set_dirty(uint8_t row);
+/* rows modified since last call */
+matrix_dirty_t matrix_get_dirty(void);
+#endif
+
+/* debounce rows read from switches into matrix state(common/debounce.c)
+ * returns true when matrix is changed */
+bool matrix_debounce(matrix_row_t matrix[], const matrix_row_t raw[]);
+
 /* power control */
 void matrix_power_up(void);
 void matrix_power_down(void);
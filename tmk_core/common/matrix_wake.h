@@ -0,0 +1,50 @@
+#ifndef MATRIX_WAKE_H
+#define MATRIX_WAKE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*
+ * Wait for any key
+ *
+ * When matrix has been idle for MATRIX_WAKE_IDLE ms keyboard_task() calls
+ * matrix_power_down() and stops scanning. Board selects all rows at once
+ * there so that a key down on any row pulls its column, and keyboard_task()
+ * only checks columns with matrix_wake_key() until a key goes down, then
+ * calls matrix_power_up() and scans as usual.
+ *
+ * Columns on PCINT0-7 given with MATRIX_WAKE_PCMSK in config.h also wake
+ * MCU from sleep with pin change interrupt, e.g. in USB suspend.
+ *
+ * Board opts in with MATRIX_WAKE_ENABLE = yes and these in matrix.c:
+ *
+ *      bool matrix_wake_key(void) { return read_cols(); }
+ *      void matrix_power_down(void) { select_all_rows(); matrix_wake_start(); }
+ *      void matrix_power_up(void) { matrix_wake_stop(); unselect_rows(); }
+ *
+ * AVR only. Matrix should have diodes, otherwise all rows selected short
+ * them through keys pressed.
+ */
+#ifndef MATRIX_WAKE_IDLE
+#define MATRIX_WAKE_IDLE    100
+#endif
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* call before matrix_scan(), returns false while waiting for key */
+bool matrix_wake_task(void);
+/* for matrix_power_down() and matrix_power_up() of board */
+void matrix_wake_start(void);
+void matrix_wake_stop(void);
+/* implemented by board: any key down with all rows selected */
+bool matrix_wake_key(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -33,6 +33,13 @@
 #define sendchar(c)    xputc(c)
 
 
+void print_set_sendchar(int8_t (*sendchar_func)(uint8_t))
+{
+    xdev_out(sendchar_func);
+}
+
+#elif defined(PLATFORM_HOST) /* __AVR__ */
+
 void print_set_sendchar(int8_t (*sendchar_func)(uint8_t))
 {
     xdev_out(sendchar_func);
@@ -50,6 +50,18 @@ extern "C"
 /* function pointer of sendchar to be used by print utility */
 void print_set_sendchar(int8_t (*print_sendchar_func)(uint8_t));
 
+#elif defined(PLATFORM_HOST) /* __AVR__ */
+
+#include "host/xprintf.h"
+#define print(s)    xputs(s)
+#define println(s)  xputs(s "\r\n")
+
+#ifdef __cplusplus
+extern "C"
+#endif
+/* function pointer of sendchar to be used by print utility */
+void print_set_sendchar(int8_t (*print_sendchar_func)(uint8_t));
+
 #elif defined(PROTOCOL_CHIBIOS) /* __AVR__ */
 
 #include "chibios/printf.h"
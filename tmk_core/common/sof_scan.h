@@ -0,0 +1,44 @@
+#ifndef SOF_SCAN_H
+#define SOF_SCAN_H
+
+#include <stdint.h>
+
+
+/*
+ * Start-of-Frame aligned scan
+ *
+ * Define SOF_SCAN_PHASE in config.h to start each scan SOF_SCAN_PHASE us
+ * after USB Start-of-Frame instead of running scans back to back. Result of
+ * the scan is ready at fixed point of every frame and MCU can idle rest of
+ * the frame. Tune the phase so that scan and report write complete before
+ * host polls the endpoint; 'scan' max of Magic+s and 'ep' of latency trace
+ * tell how long they take.
+ *
+ * Protocol driver implements these and calls them around keyboard_task().
+ * Scan runs free when SOF doesn't come, like in suspend or before
+ * configured. LUFA and ChibiOS only.
+ */
+typedef struct {
+    uint16_t frames;        /* scans started on SOF */
+    uint16_t missed;        /* scans which ran over next SOF */
+    uint16_t scan_max;      /* max time from SOF to end of scan in us */
+} sof_scan_stat_t;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* wait for SOF and phase */
+void sof_scan_wait(void);
+/* end of scan */
+void sof_scan_done(void);
+
+const sof_scan_stat_t *sof_scan_stat(void);
+void sof_scan_clear_stat(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*
+ * Single-producer single-consumer ring buffer
+ *
+ * For data passed between ISR and main loop. Only one side puts and only the
+ * other side gets, then no interrupt masking is needed: head is written by
+ * producer alone and tail by consumer alone, both are one byte which is
+ * read and written atomically.
+ *
+ * SPSC_RING_DEFINE(name, type, size) defines name_t and its functions.
+ * Size is power of 2 up to 128 and all of the slots can be used.
+ *
+ *      SPSC_RING_DEFINE(rbuf, uint8_t, 16)
+ *      static rbuf_t rb;
+ *
+ *      ISR:        if (!rbuf_put(&rb, data)) { full }
+ *      main loop:  uint8_t d; while (rbuf_get(&rb, &d)) { ... }
+ *
+ * name_reset() discards all data and is for consumer side.
+ */
+
+/* keep compiler from moving buffer access across index update */
+#define SPSC_RING_BARRIER()     __asm__ __volatile__ ("" ::: "memory")
+/* inline always, call from ISR makes it save all call-used registers */
+#define SPSC_RING_INLINE        static inline __attribute__ ((__always_inline__))
+
+#define SPSC_RING_DEFINE(name, type, size) \
+typedef struct { \
+    type buffer[size]; \
+    volatile uint8_t head; \
+    volatile uint8_t tail; \
+} name##_t; \
+\
+typedef char name##_size_check[(((size) & ((size) - 1)) == 0 && (size) <= 128) ? 1 : -1]; \
+\
+SPSC_RING_INLINE uint8_t name##_count(const name##_t *r) \
+{ \
+    return (uint8_t)(r->head - r->tail); \
+} \
+SPSC_RING_INLINE bool name##_is_empty(const name##_t *r) \
+{ \
+    return r->head == r->tail; \
+} \
+SPSC_RING_INLINE bool name##_is_full(const name##_t *r) \
+{ \
+    return name##_count(r) == (size); \
+} \
+/* producer */ \
+SPSC_RING_INLINE bool name##_put(name##_t *r, type data) \
+{ \
+    uint8_t head = r->head; \
+    if ((uint8_t)(head - r->tail) == (size)) return false; \
+    r->buffer[head & ((size) - 1)] = data; \
+    SPSC_RING_BARRIER(); \
+    r->head = head + 1; \
+    return true; \
+} \
+/* consumer */ \
+SPSC_RING_INLINE void name##_reset(name##_t *r) \
+{ \
+    r->tail = r->head; \
+} \
+SPSC_RING_INLINE bool name##_get(name##_t *r, type *data) \
+{ \
+    uint8_t tail = r->tail; \
+    if (r->head == tail) return false; \
+    *data = r->buffer[tail & ((size) - 1)]; \
+    SPSC_RING_BARRIER(); \
+    r->tail = tail + 1; \
+    return true; \
+} \
+SPSC_RING_INLINE bool name##_peek(const name##_t *r, type *data) \
+{ \
+    uint8_t tail = r->tail; \
+    if (r->head == tail) return false; \
+    *data = r->buffer[tail & ((size) - 1)]; \
+    return true; \
+} \
+/* gets up to n and returns number of data got */ \
+SPSC_RING_INLINE uint8_t name##_get_batch(name##_t *r, type *data, uint8_t n) \
+{ \
+    uint8_t tail = r->tail; \
+    uint8_t count = r->head - tail; \
+    if (n > count) n = count; \
+    for (uint8_t i = 0; i < n; i++) { \
+        data[i] = r->buffer[(uint8_t)(tail + i) & ((size) - 1)]; \
+    } \
+    SPSC_RING_BARRIER(); \
+    r->tail = tail + n; \
+    return n; \
+}
+
+#endif
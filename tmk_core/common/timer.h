@@ -22,6 +22,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #if defined(__AVR__)
 #include "avr/timer_avr.h"
+#elif defined(PLATFORM_HOST)
+#include "host/timer_host.h"
 #endif
 
 
@@ -0,0 +1,190 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include "progmem.h"
+#include "print.h"
+#include "tlog.h"
+#if defined(__AVR__)
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#elif defined(PROTOCOL_CHIBIOS)
+#include "ch.h"
+#endif
+
+
+#if ((TLOG_BUFFER_SIZE & (TLOG_BUFFER_SIZE - 1)) != 0 || TLOG_BUFFER_SIZE > 128)
+#   error "TLOG_BUFFER_SIZE must be power of 2 up to 128"
+#endif
+#if (TLOG_RECORD_SIZE < 8 || TLOG_RECORD_SIZE > 64)
+#   error "TLOG_RECORD_SIZE must be 8 to 64"
+#endif
+
+/* tlog() can be called from ISR as well as main loop */
+#if defined(__AVR__)
+#   define LOCK()       uint8_t sreg = SREG; cli()
+#   define UNLOCK()     SREG = sreg
+#   define FMT_ID(fmt)  ((uint16_t)(fmt))
+#else
+#   if defined(PROTOCOL_CHIBIOS)
+#       define LOCK()   syssts_t sts = chSysGetStatusAndLockX()
+#       define UNLOCK() chSysRestoreStatusX(sts)
+#   else
+#       define LOCK()
+#       define UNLOCK()
+#   endif
+extern const char __start_tlog_fmt[];
+#   define FMT_ID(fmt)  ((uint16_t)((fmt) - __start_tlog_fmt))
+#endif
+
+#define MASK    (TLOG_BUFFER_SIZE - 1)
+
+/* length byte followed by record, indexes run free */
+static uint8_t buffer[TLOG_BUFFER_SIZE];
+static volatile uint8_t head = 0;
+static volatile uint8_t tail = 0;
+
+/* drops not yet told and in total */
+static uint16_t lost = 0;
+static uint16_t dropped = 0;
+
+
+static void ring_put(const uint8_t *rec, uint8_t len)
+{
+    uint8_t h = head;
+    buffer[h++ & MASK] = len;
+    for (uint8_t i = 0; i < len; i++) {
+        buffer[h++ & MASK] = rec[i];
+    }
+    head = h;
+}
+
+static void put(const uint8_t *rec, uint8_t len)
+{
+    LOCK();
+    uint8_t space = TLOG_BUFFER_SIZE - (uint8_t)(head - tail);
+    uint8_t need = 1 + len + (lost ? 1 + 4 : 0);
+    if (space < need) {
+        if (lost < UINT16_MAX) lost++;
+        if (dropped < UINT16_MAX) dropped++;
+    } else {
+        if (lost) {
+            uint8_t notice[4] = { TLOG_ID_LOST & 0xFF, TLOG_ID_LOST >> 8, lost & 0xFF, lost >> 8 };
+            ring_put(notice, 4);
+            lost = 0;
+        }
+        ring_put(rec, len);
+    }
+    UNLOCK();
+}
+
+void tlog_write(const char *fmt, ...)
+{
+    uint8_t rec[TLOG_RECORD_SIZE];
+    uint16_t id = FMT_ID(fmt);
+    uint8_t len = 0;
+    rec[len++] = id & 0xFF;
+    rec[len++] = id >> 8;
+
+    va_list ap;
+    va_start(ap, fmt);
+    char c;
+    while ((c = pgm_read_byte(fmt++))) {
+        if (c != '%') continue;
+
+        /* flag and width are for decoder */
+        do { c = pgm_read_byte(fmt++); } while (c >= '0' && c <= '9');
+        uint8_t size = 2;
+        if (c == 'l') { size = 4; c = pgm_read_byte(fmt++); }
+
+        switch (c) {
+            case '\0':
+                goto end;
+            case 'c':
+                size = 1;
+                /* fall through */
+            case 'd':
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'b':
+            case 'o': {
+                uint32_t v = (size == 4) ? (uint32_t)va_arg(ap, unsigned long) : va_arg(ap, unsigned int);
+                for (; size && len < TLOG_RECORD_SIZE; size--, v >>= 8) {
+                    rec[len++] = v & 0xFF;
+                }
+                break;
+            }
+            case 's':
+            case 'S': {
+                const char *s = va_arg(ap, const char *);
+                bool pgm = (c == 'S');
+                if (len == TLOG_RECORD_SIZE) break;
+                do {
+                    c = pgm ? pgm_read_byte(s++) : *s++;
+                    if (len == TLOG_RECORD_SIZE - 1) c = '\0';
+                    rec[len++] = c;
+                } while (c);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+end:
+    va_end(ap);
+    put(rec, len);
+}
+
+/* COBS: zero is replaced with distance to next zero */
+static void send(const uint8_t *rec, uint8_t len)
+{
+    xputc(TLOG_FRAME_START);
+    xputc(len + 1);
+    uint8_t i = 0;
+    for (;;) {
+        uint8_t j = i;
+        while (j < len && rec[j]) j++;
+        xputc(j - i + 1);
+        while (i < j) xputc(rec[i++]);
+        if (j == len) break;
+        i = j + 1;
+    }
+}
+
+void tlog_task(void)
+{
+    uint8_t rec[TLOG_RECORD_SIZE];
+    uint8_t sent = 0;
+    while (sent < TLOG_DRAIN_SIZE && tail != head) {
+        uint8_t t = tail;
+        uint8_t len = buffer[t++ & MASK];
+        for (uint8_t i = 0; i < len; i++) {
+            rec[i] = buffer[t++ & MASK];
+        }
+        tail = t;
+        send(rec, len);
+        sent += len;
+    }
+
+    /* drops after the last record in ring */
+    if (lost && tail == head) {
+        uint16_t n = 0;
+        {
+            LOCK();
+            if (tail == head) {
+                n = lost;
+                lost = 0;
+            }
+            UNLOCK();
+        }
+        if (n) {
+            uint8_t notice[4] = { TLOG_ID_LOST & 0xFF, TLOG_ID_LOST >> 8, n & 0xFF, n >> 8 };
+            send(notice, 4);
+        }
+    }
+}
+
+uint16_t tlog_dropped(void)
+{
+    return dropped;
+}
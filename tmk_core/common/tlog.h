@@ -0,0 +1,78 @@
+#ifndef TLOG_H
+#define TLOG_H
+
+#include <stdint.h>
+
+
+/*
+ * Tokenized log
+ *
+ * tlog() puts ID of format string and raw argument values into a ring
+ * instead of formatting text, then tlog_task() sends them to console from
+ * main loop. Format strings are placed in their own section and
+ * tool/host/tlog_decode finds them in ELF file of the firmware to make text.
+ *
+ * ID is 16-bit address of format in flash on AVR and offset in section
+ * 'tlog_fmt' on ChibiOS and host.
+ *
+ * Format is same as xprintf. Values of %c take one byte, %d %u %X %b two
+ * bytes and four with 'l'. String of %s(RAM) and %S(flash) is copied with
+ * its terminator and truncated at end of record. Format must be literal.
+ *
+ * Record on console:
+ *      01 len COBS(id_lo id_hi values...)
+ *
+ * COBS keeps zero out of record and len is number of bytes encoded. Text of
+ * print() and xprintf() goes between records as it is. When ring is full
+ * record is dropped and count of drops is sent with ID FFFF before next one.
+ */
+
+/* bytes of ring, power of 2 up to 128 */
+#ifndef TLOG_BUFFER_SIZE
+#define TLOG_BUFFER_SIZE    128
+#endif
+
+/* max bytes of a record including ID */
+#ifndef TLOG_RECORD_SIZE
+#define TLOG_RECORD_SIZE    24
+#endif
+
+/* bytes sent per tlog_task() call at least, records are not split */
+#ifndef TLOG_DRAIN_SIZE
+#define TLOG_DRAIN_SIZE     32
+#endif
+
+#define TLOG_FRAME_START    0x01
+#define TLOG_ID_LOST        0xFFFF
+
+
+#if defined(__AVR__)
+/* in flash below 64KB with other progmem, see *(.progmem*) in linker script */
+#   define TLOG_SECTION     ".progmem.tlog"
+#elif defined(PLATFORM_HOST) || defined(PROTOCOL_CHIBIOS)
+/* orphan section placed with rodata by GNU ld, which defines __start_tlog_fmt */
+#   define TLOG_SECTION     "tlog_fmt"
+#else
+#   error "TLOG_ENABLE is supported only on AVR, ChibiOS and host"
+#endif
+
+#define tlog(fmt, ...)  do { \
+    static const char tlog_fmt[] __attribute__ ((section(TLOG_SECTION), used)) = fmt; \
+    tlog_write(tlog_fmt, ##__VA_ARGS__); \
+} while (0)
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void tlog_write(const char *fmt, ...);
+void tlog_task(void);
+/* records dropped in total */
+uint16_t tlog_dropped(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -9,6 +9,10 @@ extern "C" {
 #   include <util/delay.h>
 #   define wait_ms(ms)  _delay_ms(ms)
 #   define wait_us(us)  _delay_us(us)
+#elif defined(PLATFORM_HOST) /* __AVR__ */
+#   include "host/timer_host.h"
+#   define wait_ms(ms)  timer_host_advance(ms)
+#   define wait_us(us)  timer_host_advance_us(us)
 #elif defined(PROTOCOL_CHIBIOS) /* __AVR__ */
 #   include "ch.h"
 #   define wait_ms(ms) chThdSleepMilliseconds(ms)
@@ -46,6 +46,11 @@ ifeq (yes,$(strip $(SERIAL_MOUSE_USE_UART)))
     SRC += $(PROTOCOL_DIR)/serial_uart.c
 endif
 
+ifeq (yes,$(strip $(ADB_USE_TIMER)))
+    SRC += protocol/adb_timer.c
+    OPT_DEFS += -DADB_USE_TIMER
+endif
+
 ifeq (yes,$(strip $(ADB_MOUSE_ENABLE)))
 	 OPT_DEFS += -DADB_MOUSE_ENABLE -DMOUSE_ENABLE
 endif
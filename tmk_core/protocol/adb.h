@@ -116,6 +116,11 @@ void     adb_host_kbd_led(uint8_t addr, uint8_t led);
 void     adb_mouse_task(void);
 void     adb_mouse_init(void);
 bool     adb_service_request(void);
+#ifdef ADB_USE_TIMER
+// Talk in background and collect with adb_host_talk_buf(), see adb_timer.c
+bool     adb_host_busy(void);
+bool     adb_host_talk_start(uint8_t addr, uint8_t reg);
+#endif
 
 
 #endif
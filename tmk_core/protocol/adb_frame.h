@@ -0,0 +1,63 @@
+#ifndef ADB_FRAME_H
+#define ADB_FRAME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*
+ * Decoder of ADB bit cells from time of edges
+ *
+ * A cell starts with falling edge and its bit is 1 when low part is shorter
+ * than high part. First cell is start bit and the last one is stop bit whose
+ * high part doesn't end with falling edge, caller ends frame when line stays
+ * high longer than a cell(130us). Time is count of any 16-bit free running
+ * counter.
+ *
+ * Used by adb_timer.c in ISR and by tool/host/adb_sim.c.
+ */
+typedef struct {
+    uint8_t *buf;
+    uint8_t len;
+    uint8_t cells;      // cells started
+    uint16_t fall;
+    uint16_t rise;
+} adb_frame_t;
+
+
+static inline void adb_frame_init(adb_frame_t *f, uint8_t *buf, uint8_t len)
+{
+    for (uint8_t i = 0; i < len; i++) buf[i] = 0;
+    f->buf = buf;
+    f->len = len;
+    f->cells = 0;
+}
+
+static inline void adb_frame_fall(adb_frame_t *f, uint16_t t)
+{
+    // cell before ends, data bits follow start bit
+    if (f->cells >= 2) {
+        uint8_t n = f->cells - 2;
+        if (n/8 < f->len) {
+            f->buf[n/8] <<= 1;
+            if ((uint16_t)(f->rise - f->fall) < (uint16_t)(t - f->rise)) {
+                f->buf[n/8] |= 1;
+            }
+        }
+    }
+    if (f->cells < UINT8_MAX) f->cells++;
+    f->fall = t;
+}
+
+static inline void adb_frame_rise(adb_frame_t *f, uint16_t t)
+{
+    f->rise = t;
+}
+
+// bytes received, can be more than len of buf
+static inline uint8_t adb_frame_bytes(adb_frame_t *f)
+{
+    return (f->cells < 2) ? 0 : (f->cells - 2) / 8;
+}
+
+#endif
@@ -0,0 +1,423 @@
+/*
+ * ADB host driven by Timer1 and external interrupt
+ *
+ * Alternative to adb.c with same API. Transaction runs in background and
+ * interrupts are not disabled for it: Timer1 compare match steps signal of
+ * host and INT of data line takes TCNT1 at edges of device response, see
+ * adb_frame.h for decoding. Signaling and timing follow adb.c.
+ *
+ * Blocking calls of adb.h wait for end of transaction with interrupts
+ * enabled. adb_host_talk_start() returns at once and adb_host_talk_buf()
+ * to same address and register collects its response later without bus
+ * access, so that matrix_scan() needn't wait for device. The response is
+ * kept aside from blocking calls until collected and no other talk can be
+ * started in background before that.
+ *
+ * Data line must be on INT0-3(PD0-3) and Timer1 is used exclusively. Time
+ * of edge is late by latency of other ISR, keep them short.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <util/delay.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "adb.h"
+#include "adb_frame.h"
+
+
+#ifndef ADB_INT
+#define ADB_INT     ADB_DATA_BIT
+#endif
+#if (ADB_INT > 3)
+#   error "ADB data line must be on INT0-3."
+#endif
+#define INT_VECT_(n)    INT ## n ## _vect
+#define INT_VECT(n)     INT_VECT_(n)
+
+// Timer1 clock is F_CPU/8
+#if (F_CPU % 8000000)
+#   error "F_CPU must be multiple of 8MHz."
+#endif
+#define TICKS(us)   ((uint16_t)((us) * (F_CPU / 8000000)))
+
+#define data_lo() (ADB_DDR |=  (1<<ADB_DATA_BIT))
+#define data_hi() (ADB_DDR &= ~(1<<ADB_DATA_BIT))
+#define data_in() (ADB_PIN &   (1<<ADB_DATA_BIT))
+
+#ifdef ADB_PSW_BIT
+static inline void psw_lo(void);
+static inline void psw_hi(void);
+static inline bool psw_in(void);
+#endif
+
+
+enum {
+    IDLE,
+    CMD,        // attention, command and stop bit
+    SRQ,        // device holds stop bit
+    TLT,        // stop to start of listen
+    LISTEN,     // start bit, data and stop bit
+    TALK,       // wait for start bit of device
+    RECV,       // device sends data
+    GAP,        // bus idle before next command
+};
+static volatile uint8_t state = IDLE;
+
+// bits to send: command and data of listen
+static uint8_t tx_buf[1 + 8];
+static uint8_t tx_bit;
+static uint8_t tx_end;
+static uint8_t tx_data_end;
+static bool tx_low;
+static uint16_t tx_high;
+
+// response of background talk and of blocking call
+typedef struct {
+    uint8_t cmd;
+    uint8_t len;
+    bool    valid;
+    uint8_t buf[8];
+} result_t;
+static result_t bg;
+static result_t fg;
+static result_t *rx = &fg;
+static adb_frame_t frame;
+static volatile bool adb_srq = false;
+
+
+static inline void schedule(uint16_t ticks)
+{
+    OCR1A += ticks;
+}
+
+static inline void int_enable(void)
+{
+    EIFR = (1<<ADB_INT);
+    EIMSK |= (1<<ADB_INT);
+}
+
+static inline void int_disable(void)
+{
+    EIMSK &= ~(1<<ADB_INT);
+}
+
+static inline void place_cell(uint16_t lo, uint16_t hi)
+{
+    data_lo();
+    tx_low = true;
+    tx_high = TICKS(hi);
+    schedule(TICKS(lo));
+}
+
+static void gap(void)
+{
+    int_disable();
+    data_hi();
+    state = GAP;
+    schedule(TICKS(200));
+}
+
+// after command and its SRQ
+static void next_phase(void)
+{
+    switch (rx->cmd & 0x0C) {
+    case ADB_CMD_LISTEN:
+        state = TLT;
+        schedule(TICKS(200));
+        break;
+    case ADB_CMD_TALK:
+        // Tlt(140-260us) to start bit
+        adb_frame_init(&frame, rx->buf, sizeof(rx->buf));
+        state = TALK;
+        int_enable();
+        schedule(TICKS(500));
+        break;
+    default:
+        // flush and reset
+        gap();
+        break;
+    }
+}
+
+// step of host signal or timeout
+ISR(TIMER1_COMPA_vect)
+{
+    switch (state) {
+    case CMD:
+    case LISTEN:
+        if (tx_low) {
+            data_hi();
+            tx_low = false;
+            schedule(tx_high);
+        } else if (tx_bit < tx_end) {
+            if (tx_buf[tx_bit/8] & (0x80>>(tx_bit%8))) {
+                place_cell(35, 65);
+            } else {
+                place_cell(65, 35);
+            }
+            tx_bit++;
+        } else if (tx_bit == tx_end) {
+            place_cell(65, 35);     // Stopbit(0)
+            tx_bit++;
+        } else if (state == LISTEN) {
+            gap();
+        } else {
+            // device holds stop bit to request service
+            adb_srq = !data_in();
+            if (adb_srq) {
+                state = SRQ;
+                int_enable();
+                schedule(TICKS(500));
+            } else {
+                next_phase();
+            }
+        }
+        break;
+    case TLT:
+        tx_bit = 8;
+        tx_end = tx_data_end;
+        state = LISTEN;
+        place_cell(35, 65);         // Startbit(1)
+        break;
+    case RECV:
+        // line stays high after stop bit, or low(SRQ?) in error
+        rx->len = adb_frame_bytes(&frame);
+        rx->valid = true;
+        gap();
+        break;
+    case SRQ:                       // SRQ doesn't end
+    case TALK:                      // no data from device(not error)
+        rx->len = 0;
+        rx->valid = true;
+        gap();
+        break;
+    case GAP:
+    default:
+        TIMSK1 &= ~(1<<OCIE1A);
+        state = IDLE;
+        break;
+    }
+}
+
+// edge of data line
+ISR(INT_VECT(ADB_INT))
+{
+    uint16_t t = TCNT1;
+    bool hi = data_in();
+
+    switch (state) {
+    case SRQ:
+        if (!hi) break;
+        OCR1A = t;
+        TIFR1 = (1<<OCF1A);
+        next_phase();
+        break;
+    case TALK:
+        if (hi) break;
+        state = RECV;
+        /* fall through */
+    case RECV:
+        if (hi) {
+            adb_frame_rise(&frame, t);
+        } else {
+            // cell is 130us at most
+            adb_frame_fall(&frame, t);
+            OCR1A = t + TICKS(130);
+            TIFR1 = (1<<OCF1A);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+
+static inline void wait_idle(void)
+{
+    while (state != IDLE) ;
+    // results written in ISR
+    __asm__ __volatile__ ("" ::: "memory");
+}
+
+static void start(uint8_t cmd, uint8_t *data, uint8_t len, result_t *r)
+{
+    wait_idle();
+
+    if (len > 8) len = 8;
+    tx_buf[0] = cmd;
+    for (uint8_t i = 0; i < len; i++) tx_buf[1 + i] = data[i];
+    tx_data_end = 8 + len * 8;
+    rx = r;
+    rx->cmd = cmd;
+    rx->valid = false;
+
+    uint8_t sreg = SREG;
+    cli();
+    // Attention holds lo for 800us including Startbit(1)
+    tx_bit = 0;
+    tx_end = 8;
+    state = CMD;
+    OCR1A = TCNT1;
+    place_cell(800, 65);
+    TIFR1 = (1<<OCF1A);
+    TIMSK1 |= (1<<OCIE1A);
+    SREG = sreg;
+}
+
+
+void adb_host_init(void)
+{
+    ADB_PORT &= ~(1<<ADB_DATA_BIT);
+    data_hi();
+#ifdef ADB_PSW_BIT
+    psw_hi();
+#endif
+
+    // Timer1: normal mode, F_CPU/8
+    TCCR1A = 0;
+    TCCR1B = (1<<CS11);
+    TIMSK1 = 0;
+
+    // INT: any edge
+    EICRA = (EICRA & ~(3<<(ADB_INT*2))) | (1<<(ADB_INT*2));
+    int_disable();
+}
+
+#ifdef ADB_PSW_BIT
+bool adb_host_psw(void)
+{
+    return psw_in();
+}
+#endif
+
+uint16_t adb_host_kbd_recv(uint8_t addr)
+{
+    return adb_host_talk(addr, ADB_REG_0);
+}
+
+#ifdef ADB_MOUSE_ENABLE
+__attribute__ ((weak))
+void adb_mouse_init(void) {
+    return;
+}
+
+__attribute__ ((weak))
+void adb_mouse_task(void) {
+    return;
+}
+#endif
+
+bool adb_service_request(void)
+{
+    return adb_srq;
+}
+
+bool adb_host_busy(void)
+{
+    return state != IDLE;
+}
+
+// background talk not collected yet
+static inline bool bg_pending(void)
+{
+    return bg.valid || (state != IDLE && rx == &bg);
+}
+
+bool adb_host_talk_start(uint8_t addr, uint8_t reg)
+{
+    uint8_t cmd = (addr<<4) | ADB_CMD_TALK | reg;
+    if (bg_pending()) return bg.cmd == cmd;
+    start(cmd, 0, 0, &bg);
+    return true;
+}
+
+uint8_t adb_host_talk_buf(uint8_t addr, uint8_t reg, uint8_t *buf, uint8_t len)
+{
+    for (int8_t i =0; i < len; i++) buf[i] = 0;
+
+    uint8_t cmd = (addr<<4) | ADB_CMD_TALK | reg;
+    result_t *r = &bg;
+    if (!(bg_pending() && bg.cmd == cmd)) {
+        r = &fg;
+        start(cmd, 0, 0, r);
+    }
+    wait_idle();
+    r->valid = false;
+
+    for (uint8_t i = 0; i < len && i < r->len && i < sizeof(r->buf); i++) {
+        buf[i] = r->buf[i];
+    }
+    return r->len;
+}
+
+uint16_t adb_host_talk(uint8_t addr, uint8_t reg)
+{
+    uint8_t len;
+    uint8_t buf[8];
+    len = adb_host_talk_buf(addr, reg, buf, 8);
+    if (len != 2) return 0;
+    return (buf[0]<<8 | buf[1]);
+}
+
+void adb_host_listen_buf(uint8_t addr, uint8_t reg, uint8_t *buf, uint8_t len)
+{
+    start((addr<<4) | ADB_CMD_LISTEN | reg, buf, len, &fg);
+    wait_idle();
+}
+
+void adb_host_listen(uint8_t addr, uint8_t reg, uint8_t data_h, uint8_t data_l)
+{
+    uint8_t buf[2] = { data_h, data_l };
+    adb_host_listen_buf(addr, reg, buf, 2);
+}
+
+void adb_host_flush(uint8_t addr)
+{
+    start((addr<<4) | ADB_CMD_FLUSH, 0, 0, &fg);
+    wait_idle();
+}
+
+void adb_host_reset(void)
+{
+    start(ADB_CMD_RESET, 0, 0, &fg);
+    wait_idle();
+}
+
+void adb_host_reset_hard(void)
+{
+    wait_idle();
+    data_lo();
+    _delay_us(3000);
+    data_hi();
+}
+
+// send state of LEDs
+void adb_host_kbd_led(uint8_t addr, uint8_t led)
+{
+    // Listen Register2
+    //  upper byte: not used
+    //  lower byte: bit2=ScrollLock, bit1=CapsLock, bit0=NumLock
+    uint16_t reg2 = adb_host_talk(addr, 2);
+    _delay_us(400);
+    adb_host_listen(addr, 2, reg2 >> 8, (reg2 & 0xF8) | (led & 0x07));
+}
+
+
+#ifdef ADB_PSW_BIT
+static inline void psw_lo()
+{
+    ADB_DDR  |=  (1<<ADB_PSW_BIT);
+    ADB_PORT &= ~(1<<ADB_PSW_BIT);
+}
+static inline void psw_hi()
+{
+    ADB_PORT |=  (1<<ADB_PSW_BIT);
+    ADB_DDR  &= ~(1<<ADB_PSW_BIT);
+}
+static inline bool psw_in()
+{
+    ADB_PORT |=  (1<<ADB_PSW_BIT);
+    ADB_DDR  &= ~(1<<ADB_PSW_BIT);
+    return ADB_PIN&(1<<ADB_PSW_BIT);
+}
+#endif
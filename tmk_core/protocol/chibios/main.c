@@ -36,6 +36,9 @@
 #endif
 #include "suspend.h"
 #include "hook.h"
+#ifdef SOF_SCAN_PHASE
+#include "sof_scan.h"
+#endif
 
 
 /* -------------------------
@@ -157,6 +160,12 @@ int main(void) {
 #endif /* MOUSEKEY_ENABLE */
     }
 
+#ifdef SOF_SCAN_PHASE
+    sof_scan_wait();
+#endif
     keyboard_task();
+#ifdef SOF_SCAN_PHASE
+    sof_scan_done();
+#endif
   }
 }
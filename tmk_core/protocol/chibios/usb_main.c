@@ -28,6 +28,12 @@
 #include "led.h"
 #endif
 #include "hook.h"
+#ifdef CONSOLE_ENABLE
+#include "console.h"
+#endif
+#ifdef SOF_SCAN_PHASE
+#include "sof_scan.h"
+#endif
 
 /* TMK hooks */
 __attribute__((weak))
@@ -78,6 +84,14 @@ static uint8_t console_queue_buffer[BQ_BUFFER_SIZE(CONSOLE_QUEUE_CAPACITY, CONSO
 static virtual_timer_t console_flush_timer;
 void console_queue_onotify(io_buffers_queue_t *bqp);
 static void console_flush_cb(void *arg);
+#ifdef CONSOLE_DROP_OLDEST
+#error "CONSOLE_DROP_OLDEST is not supported on ChibiOS"
+#endif
+/* bytes lost on full queue */
+static uint16_t console_lost_count = 0;
+#ifdef CONSOLE_LOST_MARKER
+static uint16_t console_lost_pending = 0;
+#endif
 #endif /* CONSOLE_ENABLE */
 
 /* ---------------------------------------------------------
@@ -1080,12 +1094,85 @@ void nkro_in_cb(USBDriver *usbp, usbep_t ep) {
 }
 #endif /* NKRO_ENABLE */
 
+#ifdef SOF_SCAN_PHASE
+/* Start-of-Frame aligned scan: see common/sof_scan.h
+ * phase is rounded up to system tick, use tickless mode for fine phase */
+static BSEMAPHORE_DECL(sof_sem, true);
+static volatile systime_t sof_time;
+static volatile uint8_t sof_count = 0;
+static systime_t scan_time;
+static uint8_t scan_sof = 0;
+static bool scan_synced = false;
+static sof_scan_stat_t sof_stat;
+#endif
+
 /* start-of-frame handler
  * TODO: i guess it would be better to re-implement using timers,
  *  so that this is not going to have to be checked every 1ms */
 void kbd_sof_cb(USBDriver *usbp) {
   (void)usbp;
+#ifdef SOF_SCAN_PHASE
+  osalSysLockFromISR();
+  sof_time = chVTGetSystemTimeX();
+  sof_count++;
+  chBSemSignalI(&sof_sem);
+  osalSysUnlockFromISR();
+#endif
+}
+
+#ifdef SOF_SCAN_PHASE
+void sof_scan_wait(void) {
+  msg_t msg = MSG_OK;
+
+  scan_synced = false;
+  if(USB_DRIVER.state != USB_ACTIVE)
+    return;
+
+  osalSysLock();
+  if(sof_count == scan_sof) {
+    /* drop signal of SOF which came during last scan */
+    chBSemResetI(&sof_sem, true);
+    msg = chBSemWaitTimeoutS(&sof_sem, TIME_MS2I(2));
+  }
+  scan_sof = sof_count;
+  scan_time = sof_time;
+  osalSysUnlock();
+
+  /* SOF not coming */
+  if(msg == MSG_TIMEOUT)
+    return;
+
+  sysinterval_t elapsed = chVTTimeElapsedSinceX(scan_time);
+  if(elapsed < TIME_US2I(SOF_SCAN_PHASE))
+    chThdSleep(TIME_US2I(SOF_SCAN_PHASE) - elapsed);
+
+  scan_synced = true;
+  if(sof_stat.frames != UINT16_MAX)
+    sof_stat.frames++;
+}
+
+void sof_scan_done(void) {
+  if(!scan_synced)
+    return;
+
+  if(sof_count != scan_sof) {
+    if(sof_stat.missed != UINT16_MAX)
+      sof_stat.missed++;
+    return;
+  }
+  uint32_t us = TIME_I2US(chVTTimeElapsedSinceX(scan_time));
+  if(us > sof_stat.scan_max)
+    sof_stat.scan_max = us;
+}
+
+const sof_scan_stat_t *sof_scan_stat(void) {
+  return &sof_stat;
+}
+
+void sof_scan_clear_stat(void) {
+  sof_stat = (sof_scan_stat_t){};
 }
+#endif
 
 /* Idle requests timer code
  * callback (called from ISR, unlocked state) */
@@ -1362,14 +1449,46 @@ int8_t sendchar(uint8_t c) {
     osalSysUnlock();
     return 0;
   }
+#ifdef CONSOLE_LOST_MARKER
+  /* an empty buffer in queue has room for the marker */
+  bool put_marker = console_lost_pending && bqSpaceI(&console_buf_queue) > 0;
+#endif
   osalSysUnlock();
-  /* Timeout after 100us if the queue is full.
-   * Increase this timeout if too much stuff is getting
-   * dropped (i.e. the buffer is getting full too fast
-   * for USB/HIDRAW to dequeue). Another possibility
-   * for fixing this kind of thing is to increase
-   * CONSOLE_QUEUE_CAPACITY. */
-  return(obqPutTimeout(&console_buf_queue, c, US2ST(100)));
+
+#ifdef CONSOLE_LOST_MARKER
+  if (put_marker) {
+    uint8_t marker[CONSOLE_LOST_MARKER_SIZE];
+    console_lost_marker(marker, console_lost_pending);
+    for (uint8_t i = 0; i < CONSOLE_LOST_MARKER_SIZE; i++) {
+      obqPutTimeout(&console_buf_queue, marker[i], TIME_IMMEDIATE);
+    }
+    console_lost_pending = 0;
+  }
+  if (console_lost_pending) {
+    if (console_lost_pending < UINT16_MAX) console_lost_pending++;
+    if (console_lost_count < UINT16_MAX) console_lost_count++;
+    return MSG_TIMEOUT;
+  }
+#endif
+
+  /* Never wait for the queue. When it is full the byte is lost and counted,
+   * increase CONSOLE_QUEUE_CAPACITY if that happens often. */
+  msg_t ret = obqPutTimeout(&console_buf_queue, c, TIME_IMMEDIATE);
+  if (ret != MSG_OK) {
+#ifdef CONSOLE_LOST_MARKER
+    console_lost_pending = 1;
+#endif
+    if (console_lost_count < UINT16_MAX) console_lost_count++;
+  }
+  return ret;
+}
+
+uint16_t console_lost(void) {
+  return console_lost_count;
+}
+
+void console_clear_lost(void) {
+  console_lost_count = 0;
 }
 
 #else /* CONSOLE_ENABLE */
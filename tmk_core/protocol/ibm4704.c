@@ -4,7 +4,7 @@ Copyright 2010,2011,2012,2013 Jun WAKO <wakojun@gmail.com>
 #include <stdbool.h>
 #include <util/delay.h>
 #include "debug.h"
-#include "ring_buffer.h"
+#include "spsc_ring.h"
 #include "ibm4704.h"
 
 
@@ -18,6 +18,11 @@ Copyright 2010,2011,2012,2013 Jun WAKO <wakojun@gmail.com>
 
 uint8_t ibm4704_error = 0;
 
+/* scan codes from ISR */
+#define RBUF_SIZE 32
+SPSC_RING_DEFINE(ibm4704_buf, uint8_t, RBUF_SIZE)
+static ibm4704_buf_t rbuf;
+
 
 void ibm4704_init(void)
 {
@@ -99,16 +104,18 @@ ERROR:
 /* wait forever to receive data */
 uint8_t ibm4704_recv_response(void)
 {
-    while (!rbuf_has_data()) {
+    uint8_t data;
+    while (!ibm4704_buf_get(&rbuf, &data)) {
         _delay_ms(1);
     }
-    return rbuf_dequeue();
+    return data;
 }
 
 uint8_t ibm4704_recv(void)
 {
-    if (rbuf_has_data()) {
-        return rbuf_dequeue();
+    uint8_t data;
+    if (ibm4704_buf_get(&rbuf, &data)) {
+        return data;
     } else {
         return -1;
     }
@@ -167,7 +174,9 @@ ISR(IBM4704_INT_VECT)
         case STOP:
             // Data:Low
             WAIT(data_lo, 100, state);
-            rbuf_enqueue(data);
+            if (!ibm4704_buf_put(&rbuf, data)) {
+                print("rbuf: full\n");
+            }
             ibm4704_error = IBM4704_ERR_NONE;
             goto DONE;
             break;
@@ -41,7 +41,6 @@ POSSIBILITY OF SUCH DAMAGE.
 
 #include <stdbool.h>
 #include <avr/interrupt.h>
-#include <util/atomic.h>
 #include "debug.h"
 #include "timer.h"
 #include "wait.h"
@@ -57,9 +56,15 @@ POSSIBILITY OF SUCH DAMAGE.
 
 
 IBMPC IBMPC::interface0 = IBMPC(IBMPC_CLOCK_BIT, IBMPC_DATA_BIT);
-#if defined(IBMPC_CLOCK_BIT1) && defined(IBMPC_DATA_BIT1)
+#if IBMPC_INTERFACES > 1
 IBMPC IBMPC::interface1 = IBMPC(IBMPC_CLOCK_BIT1, IBMPC_DATA_BIT1);
 #endif
+#if IBMPC_INTERFACES > 2
+IBMPC IBMPC::interface2 = IBMPC(IBMPC_CLOCK_BIT2, IBMPC_DATA_BIT2);
+#endif
+#if IBMPC_INTERFACES > 3
+IBMPC IBMPC::interface3 = IBMPC(IBMPC_CLOCK_BIT3, IBMPC_DATA_BIT3);
+#endif
 
 
 void IBMPC::host_init(void)
@@ -177,20 +182,18 @@ ERROR:
  */
 int16_t IBMPC::host_recv(void)
 {
-    int16_t ret = -1;
+    uint8_t data;
 
     // Enable ISR if buffer was full
-    if (ringbuf_is_full()) {
+    if (ibmpc_ring_is_full(&rb)) {
         host_isr_clear();
         int_on();
         idle();
     }
 
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-        ret = ringbuf_get();
-    }
-    if (ret != -1) dprintf("r%02X ", ret&0xFF);
-    return ret;
+    if (!ibmpc_ring_get(&rb, &data)) return -1;
+    dprintf("r%02X ", data);
+    return data;
 }
 
 int16_t IBMPC::host_recv_response(void)
@@ -210,7 +213,7 @@ void IBMPC::host_isr_clear(void)
     protocol = 0;
     error = 0;
     isr_state = 0x8000;
-    ringbuf_reset();
+    ibmpc_ring_reset(&rb);
 }
 
 void IBMPC::isr(void)
@@ -225,6 +228,9 @@ void IBMPC::isr(void)
     //t = (uint8_t)timer_count;    // compiler uses four registers instead of one
     if (isr_state == 0x8000) {
         timer_start = t;
+#ifdef IBMPC_CAPTURE
+        cap_rec.start_ms = cap_time(&cap_rec.start_tick);
+#endif
     } else {
         // This gives 10ms at least before timeout
         if ((uint8_t)(t - timer_start) > 10) {
@@ -379,21 +385,28 @@ DONE:
 #endif
 
     // store data
-    ringbuf_put(isr_state & 0xFF);
-    if (ringbuf_is_full()) {
+    if (!ibmpc_ring_put(&rb, isr_state & 0xFF)) {
+        // buffer overflow
+        error = IBMPC_ERR_FULL;
+#ifdef IBMPC_CAPTURE
+        capture(isr_state & 0xFF, IBMPC_ERR_FULL);
+    } else {
+        capture(isr_state & 0xFF, IBMPC_ERR_NONE);
+#endif
+    }
+    if (ibmpc_ring_is_full(&rb)) {
         // Disable ISR if buffer is full
         int_off();
         // inhibit: clock_lo() instead of inhibit() for ISR optimization
         clock_lo();
     }
-    if (ringbuf_is_empty()) {
-        // buffer overflow
-        error = IBMPC_ERR_FULL;
-    }
     goto END;
 ERROR:
     // inhibit: Use clock_lo() instead of inhibit() for ISR optimization
     clock_lo();
+#ifdef IBMPC_CAPTURE
+    capture(0, error);
+#endif
 END:
     // clear for next data
     isr_state = 0x8000;
@@ -401,6 +414,41 @@ NEXT:
     return;
 }
 
+#ifdef IBMPC_CAPTURE
+/* COBS: zero is replaced with distance to next zero */
+static void capture_send(const uint8_t *rec, uint8_t len)
+{
+    xputc(IBMPC_CAPTURE_FRAME_START);
+    xputc(len + 1);
+    uint8_t i = 0;
+    for (;;) {
+        uint8_t j = i;
+        while (j < len && rec[j]) j++;
+        xputc(j - i + 1);
+        while (i < j) xputc(rec[i++]);
+        if (j == len) break;
+        i = j + 1;
+    }
+}
+
+/* send captured frames to console, call from main loop */
+void IBMPC::capture_task(void)
+{
+    struct {
+        uint8_t clock_bit;
+        uint8_t top;
+        ibmpc_capture_t c;
+    } __attribute__((packed)) rec;
+    rec.clock_bit = clock_bit;
+    rec.top = TIMER_RAW_TOP;
+    // a few records at a time not to hold up scan
+    for (uint8_t i = 0; i < 4; i++) {
+        if (!ibmpc_capture_ring_get(&cap, &rec.c)) break;
+        capture_send((const uint8_t *)&rec, sizeof(rec));
+    }
+}
+#endif
+
 /* send LED state to keyboard */
 void IBMPC::host_set_led(uint8_t led)
 {
@@ -418,9 +466,23 @@ ISR(IBMPC_INT_VECT)
     IBMPC::interface0.isr();
 }
 
-#if defined(IBMPC_CLOCK_BIT1) && defined(IBMPC_DATA_BIT1) && defined(IBMPC_INT_VECT1)
+#if IBMPC_INTERFACES > 1 && defined(IBMPC_INT_VECT1)
 ISR(IBMPC_INT_VECT1)
 {
     IBMPC::interface1.isr();
 }
 #endif
+
+#if IBMPC_INTERFACES > 2 && defined(IBMPC_INT_VECT2)
+ISR(IBMPC_INT_VECT2)
+{
+    IBMPC::interface2.isr();
+}
+#endif
+
+#if IBMPC_INTERFACES > 3 && defined(IBMPC_INT_VECT3)
+ISR(IBMPC_INT_VECT3)
+{
+    IBMPC::interface3.isr();
+}
+#endif
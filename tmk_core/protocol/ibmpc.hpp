@@ -40,6 +40,10 @@ POSSIBILITY OF SUCH DAMAGE.
 
 #include <stdbool.h>
 #include "wait.h"
+#include "spsc_ring.h"
+#ifdef IBMPC_CAPTURE
+#include "timer.h"
+#endif
 
 /*
  * IBM PC keyboard protocol
@@ -85,6 +89,61 @@ POSSIBILITY OF SUCH DAMAGE.
 #define IBMPC_ERR_FULL        0x40
 #define IBMPC_ERR_ILLEGAL     0x80
 
+// Size should be power of 2
+#define IBMPC_RINGBUF_SIZE    16
+SPSC_RING_DEFINE(ibmpc_ring, uint8_t, IBMPC_RINGBUF_SIZE)
+
+#ifdef IBMPC_CAPTURE
+/*
+ * Frame capture
+ *
+ * ISR records every frame it finishes, received or error, with time of its
+ * first and last clock edge, and capture_task() sends records to console
+ * from main loop. tool/host/ibmpc_capture reads them to make histograms of
+ * frame length and gap between frames.
+ *
+ * Time is low bits of millisecond timer and count of Timer0 within the
+ * millisecond, which runs TIMER_RAW_TOP+1 ticks of TIMER_RAW_TOP kHz.
+ *
+ * Record on console:
+ *      02 len COBS(clock_bit TIMER_RAW_TOP ibmpc_capture_t)
+ *
+ * Framing is same as tlog. When ring is full frame is not recorded and
+ * counted in 'lost' of next record.
+ */
+#define IBMPC_CAPTURE_FRAME_START   0x02
+
+// Size should be power of 2
+#ifndef IBMPC_CAPTURE_SIZE
+#define IBMPC_CAPTURE_SIZE          8
+#endif
+
+typedef struct {
+    uint16_t start_ms;      // first edge
+    uint8_t start_tick;
+    uint8_t end_ms;         // last edge, low 8 bits
+    uint8_t end_tick;
+    uint16_t isr_state;     // before shifting data out
+    uint8_t protocol;
+    uint8_t error;          // error of this frame only
+    uint8_t data;
+    uint8_t lost;           // frames not recorded before this
+} __attribute__((packed)) ibmpc_capture_t;
+
+SPSC_RING_DEFINE(ibmpc_capture_ring, ibmpc_capture_t, IBMPC_CAPTURE_SIZE)
+#endif
+
+// Interfaces are numbered from 0 without gap, see IBMPC_CLOCK_BIT1 and IBMPC_DATA_BIT1 in config.h
+#if defined(IBMPC_CLOCK_BIT3) && defined(IBMPC_DATA_BIT3)
+#   define IBMPC_INTERFACES     4
+#elif defined(IBMPC_CLOCK_BIT2) && defined(IBMPC_DATA_BIT2)
+#   define IBMPC_INTERFACES     3
+#elif defined(IBMPC_CLOCK_BIT1) && defined(IBMPC_DATA_BIT1)
+#   define IBMPC_INTERFACES     2
+#else
+#   define IBMPC_INTERFACES     1
+#endif
+
 #define IBMPC_LED_SCROLL_LOCK 0
 #define IBMPC_LED_NUM_LOCK    1
 #define IBMPC_LED_CAPS_LOCK   2
@@ -94,9 +153,15 @@ class IBMPC
 {
     public:
     static IBMPC interface0;
-#if defined(IBMPC_CLOCK_BIT1) && defined(IBMPC_DATA_BIT1)
+#if IBMPC_INTERFACES > 1
     static IBMPC interface1;
 #endif
+#if IBMPC_INTERFACES > 2
+    static IBMPC interface2;
+#endif
+#if IBMPC_INTERFACES > 3
+    static IBMPC interface3;
+#endif
 
     volatile uint16_t isr_debug;
     volatile uint8_t protocol;
@@ -111,6 +176,12 @@ class IBMPC
     void host_isr_clear(void);
     void host_set_led(uint8_t led);
 
+    /* received data or error to process */
+    inline bool host_pending(void)
+    {
+        return !ibmpc_ring_is_empty(&rb) || error;
+    }
+
     IBMPC(uint8_t clock, uint8_t data) :
             isr_debug(IBMPC_ERR_NONE), protocol(IBMPC_PROTOCOL_NO), error(IBMPC_ERR_NONE),
             isr_state(0x8000), timer_start(0), clock_bit(clock), data_bit(data),
@@ -118,18 +189,49 @@ class IBMPC
     };
 
     void isr(void);
+#ifdef IBMPC_CAPTURE
+    void capture_task(void);
+#endif
 
 
     private:
     volatile uint16_t isr_state;
     uint8_t timer_start;
 
-    /* ring buffer */
-    // Size should be power of 2
-    #define RINGBUF_SIZE    16
-    uint8_t rb_head;
-    uint8_t rb_tail;
-    uint8_t rb_buffer[RINGBUF_SIZE];
+    /* ring buffer: ISR puts and host_recv() gets */
+    ibmpc_ring_t rb;
+
+#ifdef IBMPC_CAPTURE
+    /* ISR puts and capture_task() gets */
+    ibmpc_capture_ring_t cap;
+    ibmpc_capture_t cap_rec;
+    uint8_t cap_lost;
+
+    // time in ISR, Timer0 may have wrapped around while timer ISR waits
+    inline uint16_t cap_time(uint8_t *tick) __attribute__((__always_inline__))
+    {
+        uint8_t t = TCNT0;
+        uint16_t ms = (uint16_t)timer_count;
+        if ((TIFR0 & (1<<OCF0A)) && t < TIMER_RAW_TOP/2) ms++;
+        *tick = t;
+        return ms;
+    }
+
+    inline void capture(uint8_t data, uint8_t err) __attribute__((__always_inline__))
+    {
+        cap_rec.end_ms = cap_time(&cap_rec.end_tick);
+        cap_rec.isr_state = isr_debug;
+        cap_rec.protocol = protocol;
+        cap_rec.error = err;
+        cap_rec.data = data;
+        cap_rec.lost = cap_lost;
+        if (ibmpc_capture_ring_put(&cap, cap_rec)) {
+            cap_lost = 0;
+        } else if (cap_lost < 0xFF) {
+            cap_lost++;
+        }
+    }
+#endif
 
     const uint8_t clock_bit, data_bit;
     const uint8_t clock_mask, data_mask;
@@ -239,37 +341,6 @@ class IBMPC
     {
         EIMSK &= ~clock_mask;
     }
-
-    /*
-     * ring buffer
-     */
-    inline int16_t ringbuf_get(void) __attribute__((__always_inline__))
-    {
-        if (ringbuf_is_empty()) return -1;
-        uint8_t data = rb_buffer[rb_tail];
-        rb_tail++;
-        rb_tail &= (RINGBUF_SIZE - 1);
-        return  data;
-    }
-    inline void ringbuf_put(uint8_t data) __attribute__((__always_inline__))
-    {
-        rb_buffer[rb_head] = data;
-        rb_head++;
-        rb_head &= (RINGBUF_SIZE - 1);
-    }
-    inline bool ringbuf_is_empty(void) __attribute__((__always_inline__))
-    {
-        return (rb_head == rb_tail);
-    }
-    inline bool ringbuf_is_full(void) __attribute__((__always_inline__))
-    {
-        return (((rb_head + 1) & (RINGBUF_SIZE - 1)) == rb_tail);
-    }
-    inline void ringbuf_reset(void) __attribute__((__always_inline__))
-    {
-        rb_head = 0;
-        rb_tail = 0;
-    }
 };
 
 #endif
@@ -0,0 +1,114 @@
+#ifndef IBMPC_CODESET_H
+#define IBMPC_CODESET_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "progmem.h"
+
+
+/*
+ * Table driven decoder of IBM PC scan code sets
+ *
+ * Tables are generated by tool/host/ibmpc_codeset.c from description of
+ * code sets, see converter/ibmpc_usb/codeset.txt. An entry of state is one
+ * of:
+ *
+ *      00-7F   key code, make or break as given by state
+ *      80-BF   prefix, go to state of low bits
+ *      C0-CF   event of IBMPC_CS_* below
+ *      D0      same as E0 and code is unknown
+ *      E0      key code same as code, bit7 cleared
+ *
+ * Decoder goes back to first state after every entry but prefix.
+ *
+ * Most codes of a state share one entry for 00-7F and one for 80-FF, the
+ * rest are exceptional. Exceptions of all states are packed into one table
+ * with row of state at each entry and state finds its exception for code at
+ * base + code when row of the entry is its own. Base wraps around in 16-bit
+ * and can be negative. States of a code set variant start from its base in
+ * state table.
+ *
+ * Used by ibmpc_usb.cpp and by the generator to check tables with corpus.
+ */
+#define IBMPC_CS_NONE       0   // prefix or ignored code
+#define IBMPC_CS_MAKE       1
+#define IBMPC_CS_BREAK      2
+#define IBMPC_CS_BIT7       3   // event of state: break if bit7 of code is set
+#define IBMPC_CS_OVERRUN    4
+#define IBMPC_CS_ERROR      5
+#define IBMPC_CS_RESET      6
+#define IBMPC_CS_UNKNOWN    7
+#define IBMPC_CS_CLEAR      8
+#define IBMPC_CS_WARN       0x10    // flag: key is unknown code itself
+
+#define IBMPC_CS_GOTO       0x80
+#define IBMPC_CS_DO         0xC0
+#define IBMPC_CS_SAME       0xE0
+
+typedef struct {
+    uint8_t dflt_lo;    // entry for codes 00-7F
+    uint8_t dflt_hi;    // entry for codes 80-FF
+    uint8_t event;      // MAKE, BREAK or BIT7
+    uint8_t row;
+    uint16_t base;      // position of code 00 in exception table
+} ibmpc_cs_state_t;
+
+typedef struct {
+    uint8_t set;
+    bool any;           // matches any keyboard ID
+    uint16_t id;
+    uint8_t base;       // first state
+} ibmpc_cs_variant_t;
+
+
+// base of states for code set and keyboard ID, 0xFF if not found
+static inline uint8_t ibmpc_cs_select(const ibmpc_cs_variant_t *v, uint8_t n, uint8_t set, uint16_t id)
+{
+    for (uint8_t i = 0; i < n; i++) {
+        if (pgm_read_byte(&v[i].set) != set) continue;
+        if (pgm_read_byte(&v[i].any) || pgm_read_word(&v[i].id) == id) {
+            return pgm_read_byte(&v[i].base);
+        }
+    }
+    return 0xFF;
+}
+
+// decode a code in state, returns event and key code for MAKE or BREAK
+static inline uint8_t ibmpc_cs_step(const ibmpc_cs_state_t *states,
+                                    const uint8_t *entries, const uint8_t *rows, uint16_t n,
+                                    uint8_t *state, uint8_t code, uint8_t *key)
+{
+    const ibmpc_cs_state_t *s = &states[*state];
+    uint16_t i = pgm_read_word(&s->base) + code;
+    uint8_t e;
+    if (i < n && pgm_read_byte(&rows[i]) == pgm_read_byte(&s->row)) {
+        e = pgm_read_byte(&entries[i]);
+    } else {
+        const uint8_t *d = (code & 0x80) ? &s->dflt_hi : &s->dflt_lo;
+        e = pgm_read_byte(d);
+    }
+
+    uint8_t ev = pgm_read_byte(&s->event);
+    if (ev == IBMPC_CS_BIT7) ev = (code & 0x80) ? IBMPC_CS_BREAK : IBMPC_CS_MAKE;
+
+    *state = 0;
+    if (e < IBMPC_CS_GOTO) {
+        *key = e;
+        return ev;
+    }
+    if (e < IBMPC_CS_DO) {
+        *state = e & 0x3F;
+        return IBMPC_CS_NONE;
+    }
+    if (e >= IBMPC_CS_SAME) {
+        *key = code & 0x7F;
+        return ev;
+    }
+    if (e & IBMPC_CS_WARN) {
+        *key = code & 0x7F;
+        return ev | IBMPC_CS_WARN;
+    }
+    return e & 0x0F;
+}
+
+#endif
@@ -45,6 +45,7 @@
 #include "led.h"
 #include "sendchar.h"
 #include "ringbuf.h"
+#include "console.h"
 #include "debug.h"
 #ifdef SLEEP_LED_ENABLE
 #include "sleep_led.h"
@@ -52,6 +53,14 @@
 #include "suspend.h"
 #include "hook.h"
 #include "timer.h"
+#include "latency_trace.h"
+#ifdef SOF_SCAN_PHASE
+#include <avr/sleep.h>
+#include "sof_scan.h"
+#endif
+#ifdef IDLE_SLEEP_ENABLE
+#include "idle_sleep.h"
+#endif
 
 #ifdef TMK_LUFA_DEBUG_SUART
 #include "avr/suart.h"
@@ -90,10 +99,16 @@ static void send_keyboard(report_keyboard_t *report);
 static void send_mouse(report_mouse_t *report);
 static void send_system(uint16_t data);
 static void send_consumer(uint16_t data);
+#if !defined(NO_KEYBOARD) && defined(REPORT_QUEUE_SIZE)
+static uint8_t keyboard_pending(void);
+#endif
 host_driver_t lufa_driver = {
 #ifndef NO_KEYBOARD
     .keyboard_leds = keyboard_leds,
     .send_keyboard = send_keyboard,
+#ifdef REPORT_QUEUE_SIZE
+    .keyboard_pending = keyboard_pending,
+#endif
 #endif
     .send_mouse = send_mouse,
     .send_system = send_system,
@@ -132,89 +147,74 @@ static bool console_is_ready(void)
     return true;
 }
 
-static bool console_putc(uint8_t c)
-{
-    // return immediately if called while interrupt
-    if (!(SREG & (1<<SREG_I)))
-        goto EXIT;
-
-    if (USB_DeviceState != DEVICE_STATE_Configured && !ringbuf_is_full(&sendbuf))
-        goto EXIT;
-
-    if (!console_is_ready() && !ringbuf_is_full(&sendbuf))
-        goto EXIT;
-
-    /* Data lost considerations:
-     * 1. When buffer is full at early satage of startup, we will have to start sending
-     * before console_is_ready() returns true. Data can be lost even if sending data
-     * seems to be successful on USB. hid_listen on host is not ready perhaps?
-     * Sometime first few packets are lost when buffer is full at startup.
-     * 2. When buffer is full and USB pipe is not ready, new coming data will be lost.
-     * 3. console_task() cannot send data in buffer while main loop is blocked.
-     */
-    /* retry timeout */
-    const uint8_t CONSOLE_TIMOUT = 5;   // 1 is too small, 2 seems to be enough for Linux
-    static uint8_t timeout = CONSOLE_TIMOUT;
-    uint16_t prev = timer_read();
-    bool done = false;
-
-    uint8_t ep = Endpoint_GetCurrentEndpoint();
-    Endpoint_SelectEndpoint(CONSOLE_IN_EPNUM);
-
-AGAIN:
-    if (Endpoint_IsStalled() || !Endpoint_IsEnabled() || !Endpoint_IsConfigured()) {
-        goto EXIT_RESTORE_EP;
-    }
+static uint16_t lost = 0;
+#ifdef CONSOLE_LOST_MARKER
+static uint16_t lost_pending = 0;
+#endif
 
-    // write from buffer to endpoint bank
-    while (!ringbuf_is_empty(&sendbuf) && Endpoint_IsReadWriteAllowed()) {
-        Endpoint_Write_8(ringbuf_get(&sendbuf));
+static void console_flush(void);
 
-        // clear bank when it is full
-        if (!Endpoint_IsReadWriteAllowed() && Endpoint_IsINReady()) {
-            Endpoint_ClearIN();
-            timeout = CONSOLE_TIMOUT; // re-enable retry only when host can receive
-        }
+/* Put into buffer and return at once, called from ISR as well.
+ * Buffer is sent by lufa_console_task() once a frame after console_is_ready().
+ * Messages at startup are kept in buffer until then and later ones are
+ * lost when it is full, see console.h for policy.
+ * When buffer is full in main loop, with interrupt enabled, what endpoint
+ * takes now is sent first without waiting for host.
+ */
+static bool console_putc(uint8_t c)
+{
+    if ((SREG & (1<<SREG_I)) && ringbuf_is_full(&sendbuf)) {
+        console_flush();
     }
 
-    // write c to bank directly if there is no others in buffer
-    if (ringbuf_is_empty(&sendbuf) && Endpoint_IsReadWriteAllowed()) {
-        Endpoint_Write_8(c);
-        done = true;
+    bool ok = true;
+    uint8_t sreg = SREG;
+    cli();
+#if defined(CONSOLE_DROP_OLDEST)
+    if (ringbuf_is_full(&sendbuf)) {
+        ringbuf_get(&sendbuf);
+        ok = false;
     }
-
-    // clear bank when there are chars in bank
-    if (Endpoint_BytesInEndpoint() && Endpoint_IsINReady()) {
-        // Windows needs to fill packet with 0
-        while (Endpoint_IsReadWriteAllowed()) {
-                Endpoint_Write_8(0);
+    ringbuf_put(&sendbuf, c);
+#elif defined(CONSOLE_LOST_MARKER)
+    if (lost_pending &&
+            ((sendbuf.tail - sendbuf.head - 1) & sendbuf.size_mask) > CONSOLE_LOST_MARKER_SIZE) {
+        uint8_t marker[CONSOLE_LOST_MARKER_SIZE];
+        console_lost_marker(marker, lost_pending);
+        for (uint8_t i = 0; i < CONSOLE_LOST_MARKER_SIZE; i++) {
+            ringbuf_put(&sendbuf, marker[i]);
         }
-        Endpoint_ClearIN();
-        timeout = CONSOLE_TIMOUT; // re-enable retry only when host can receive
+        lost_pending = 0;
     }
-
-    if (done) {
-        Endpoint_SelectEndpoint(ep);
-        return true;
+    if (lost_pending || !ringbuf_put(&sendbuf, c)) {
+        if (lost_pending < UINT16_MAX) lost_pending++;
+        ok = false;
     }
+#else
+    ok = ringbuf_put(&sendbuf, c);
+#endif
+    if (!ok && lost < UINT16_MAX) lost++;
+    SREG = sreg;
+    return ok;
+}
 
-    /* retry when buffer is full.
-     * once timeout this is disabled until host receives actually,
-     * otherwise this will block or make main loop execution sluggish.
-     */
-    if (ringbuf_is_full(&sendbuf) && timeout) {
-        uint16_t curr = timer_read();
-        if (curr != prev) {
-            timeout--;
-            prev = curr;
-        }
-        goto AGAIN;
-    }
+static int16_t console_getc(void)
+{
+    uint8_t sreg = SREG;
+    cli();
+    int16_t c = ringbuf_get(&sendbuf);
+    SREG = sreg;
+    return c;
+}
 
-EXIT_RESTORE_EP:
-    Endpoint_SelectEndpoint(ep);
-EXIT:
-    return ringbuf_put(&sendbuf, c);
+uint16_t console_lost(void)
+{
+    return lost;
+}
+
+void console_clear_lost(void)
+{
+    lost = 0;
 }
 
 static void console_flush(void)
@@ -234,8 +234,9 @@ static void console_flush(void)
     }
 
     // write from buffer to endpoint bank
-    while (!ringbuf_is_empty(&sendbuf) && Endpoint_IsReadWriteAllowed()) {
-        Endpoint_Write_8(ringbuf_get(&sendbuf));
+    int16_t c;
+    while (Endpoint_IsReadWriteAllowed() && (c = console_getc()) != -1) {
+        Endpoint_Write_8(c);
 
         // clear bank when it is full
         if (!Endpoint_IsReadWriteAllowed() && Endpoint_IsINReady()) {
@@ -255,7 +256,7 @@ static void console_flush(void)
     Endpoint_SelectEndpoint(ep);
 }
 
-static void console_task(void)
+void lufa_console_task(void)
 {
     static uint16_t fn = 0;
     if (fn == USB_Device_GetFrameNumber()) {
@@ -264,6 +265,41 @@ static void console_task(void)
     fn = USB_Device_GetFrameNumber();
     console_flush();
 }
+
+static uint8_t console_used(void)
+{
+    uint8_t sreg = SREG;
+    cli();
+    uint8_t n = (sendbuf.head - sendbuf.tail) & sendbuf.size_mask;
+    SREG = sreg;
+    return n;
+}
+
+/* Send buffer until half of it is free for next line, main loop only.
+ * Gives up when host takes nothing for a few frames, e.g. hid_listen is not
+ * running, and returns at once after that until host takes some again.
+ */
+void console_yield(void)
+{
+    static bool stalled = false;
+    if (!console_is_ready() || USB_DeviceState != DEVICE_STATE_Configured)
+        return;
+
+    uint8_t used = console_used();
+    uint16_t t = timer_read();
+    while (used >= SENDBUF_SIZE / 2) {
+        lufa_console_task();
+        uint8_t n = console_used();
+        if (n < used) {
+            stalled = false;
+            t = timer_read();
+        } else if (stalled || timer_elapsed(t) > 3) {
+            stalled = true;
+            return;
+        }
+        used = n;
+    }
+}
 #endif
 
 
@@ -323,6 +359,7 @@ void EVENT_USB_Device_Reset(void)
 #ifdef MOUSE_ENABLE
     mouse_protocol = 1;
 #endif
+    host_reports_lost();
 }
 
 void EVENT_USB_Device_Suspend()
@@ -387,8 +424,102 @@ void EVENT_USB_Device_ConfigurationChanged(void)
     ConfigSuccess &= ENDPOINT_CONFIG(NKRO_IN_EPNUM, EP_TYPE_INTERRUPT, ENDPOINT_DIR_IN,
                                      NKRO_EPSIZE, ENDPOINT_BANK_SINGLE);
 #endif
+
+#ifdef SOF_SCAN_PHASE
+    USB_Device_EnableSOFEvents();
+#endif
 }
 
+#ifdef SOF_SCAN_PHASE
+/*
+ * Start-of-Frame aligned scan: see common/sof_scan.h
+ *
+ * Time in frame is read from Timer0 which counts 0..TIMER_RAW_TOP every 1ms,
+ * its phase against SOF doesn't matter as long as scan fits in a frame.
+ */
+#define FRAME_TICKS     (TIMER_RAW_TOP + 1)
+#define PHASE_TICKS     ((uint32_t)SOF_SCAN_PHASE * FRAME_TICKS / 1000)
+
+#if (SOF_SCAN_PHASE >= 1000)
+#   error "SOF_SCAN_PHASE must be less than frame period 1000us"
+#endif
+
+static volatile uint8_t sof_count = 0;
+static volatile uint8_t sof_raw = 0;
+static uint8_t scan_sof = 0;
+static bool scan_synced = false;
+static sof_scan_stat_t sof_stat;
+
+void EVENT_USB_Device_StartOfFrame(void)
+{
+    sof_raw = TIMER_RAW;
+    sof_count++;
+}
+
+/* ticks since last SOF, valid within the frame */
+static uint8_t sof_elapsed(void)
+{
+    uint8_t sof = sof_raw;
+    uint8_t now = TIMER_RAW;
+    return (now >= sof) ? now - sof : now + FRAME_TICKS - sof;
+}
+
+void sof_scan_wait(void)
+{
+    scan_synced = false;
+    if (USB_DeviceState != DEVICE_STATE_Configured)
+        return;
+
+    /* sleep until next SOF; Timer0 interrupt wakes up every 1ms as well */
+    uint16_t t = timer_read();
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    cli();
+    while (sof_count == scan_sof) {
+        if (timer_elapsed(t) > 2) {
+            /* SOF not coming */
+            sei();
+            return;
+        }
+        sleep_enable();
+        sei();
+        sleep_cpu();
+        sleep_disable();
+        cli();
+    }
+    sei();
+
+    scan_sof = sof_count;
+    while (sof_elapsed() < PHASE_TICKS && sof_count == scan_sof) ;
+
+    scan_synced = true;
+    if (sof_stat.frames != UINT16_MAX) sof_stat.frames++;
+}
+
+void sof_scan_done(void)
+{
+    if (!scan_synced)
+        return;
+
+    uint8_t ticks = sof_elapsed();
+    if (sof_count != scan_sof) {
+        if (sof_stat.missed != UINT16_MAX) sof_stat.missed++;
+        return;
+    }
+    uint16_t us = (uint32_t)ticks * 1000 / FRAME_TICKS;
+    if (us > sof_stat.scan_max) sof_stat.scan_max = us;
+}
+
+const sof_scan_stat_t *sof_scan_stat(void)
+{
+    return &sof_stat;
+}
+
+void sof_scan_clear_stat(void)
+{
+    sof_stat = (sof_scan_stat_t){};
+}
+#endif
+
 /*
 Appendix G: HID Request Support Requirements
 
@@ -506,6 +637,7 @@ void EVENT_USB_Device_ControlRequest(void)
                     Endpoint_ClearStatusStage();
 
                     keyboard_protocol = (USB_ControlRequest.wValue & 0xFF);
+                    host_reports_lost();
 #ifdef TMK_LUFA_DEBUG
                     xprintf("[P%d %04X]", USB_ControlRequest.wIndex, USB_ControlRequest.wValue);
 #endif
@@ -517,6 +649,7 @@ void EVENT_USB_Device_ControlRequest(void)
                     Endpoint_ClearStatusStage();
 
                     mouse_protocol = (USB_ControlRequest.wValue & 0xFF);
+                    host_reports_lost();
 #ifdef TMK_LUFA_DEBUG
                     xprintf("[P%d %04X]", USB_ControlRequest.wIndex, USB_ControlRequest.wValue);
 #endif
@@ -567,14 +700,81 @@ static uint8_t keyboard_leds(void)
 {
     return keyboard_led_stats;
 }
+#endif
 
-static void send_keyboard(report_keyboard_t *report)
+/*
+ * Report queue
+ *
+ * Define REPORT_QUEUE_SIZE in config.h to queue reports instead of waiting
+ * for endpoint to be ready. Queued reports are written from main loop each
+ * time endpoint becomes ready, keyboard_task() never waits for host polling.
+ *
+ * When queue is full:
+ *  keyboard    newest report is replaced, press or release of it lost in
+ *              the replacement(host_keyboard_mergeable()) is recorded and
+ *              sent again as a stroke of the key when queue has room
+ *  mouse       movement of new report is added to the newest one
+ *  extra       new report waits for room and replaces waiting one of the
+ *              same ID, queued ones are never replaced
+ * so that the last state of keys and buttons and sum of movement get to host
+ * without waiting for endpoint. Reports put together are counted as merge,
+ * strokes which can't get to host as drop, i.e. when stroke record overflows
+ * or extra report waiting is replaced.
+ *
+ * Mouse and extra(system and consumer) reports have own queues and share
+ * endpoint, extra reports are written first.
+ */
+#ifdef REPORT_QUEUE_SIZE
+#if (REPORT_QUEUE_SIZE & (REPORT_QUEUE_SIZE - 1)) || (REPORT_QUEUE_SIZE < 2) || (REPORT_QUEUE_SIZE > 128)
+#   error "REPORT_QUEUE_SIZE must be power of 2 from 2 up to 128"
+#endif
+#define QUEUE_INDEX(i)  ((i) & (REPORT_QUEUE_SIZE - 1))
+
+static report_queue_stat_t queue_stat[REPORT_QUEUE_NUM];
+
+static void queue_merge(report_queue_stat_t *stat)
 {
-    uint8_t timeout = 128;
+    if (stat->merge != UINT16_MAX) stat->merge++;
+}
 
-    if (USB_DeviceState != DEVICE_STATE_Configured)
-        return;
+static void queue_drop(report_queue_stat_t *stat)
+{
+    if (stat->drop != UINT16_MAX) stat->drop++;
+}
 
+/* slot for new report next to newest one, or newest one when full */
+static uint8_t queue_put(report_queue_stat_t *stat, uint8_t head, bool *full)
+{
+    if (stat->depth == REPORT_QUEUE_SIZE) {
+        *full = true;
+        return QUEUE_INDEX(head + REPORT_QUEUE_SIZE - 1);
+    }
+    uint8_t i = QUEUE_INDEX(head + stat->depth);
+    stat->depth++;
+    if (stat->depth > stat->max) stat->max = stat->depth;
+    *full = false;
+    return i;
+}
+
+const report_queue_stat_t *lufa_report_queue_stat(uint8_t queue)
+{
+    return &queue_stat[queue];
+}
+
+void lufa_report_queue_clear_stat(void)
+{
+    for (uint8_t i = 0; i < REPORT_QUEUE_NUM; i++) {
+        queue_stat[i].max = queue_stat[i].depth;
+        queue_stat[i].merge = 0;
+        queue_stat[i].drop = 0;
+    }
+}
+#endif
+
+#ifndef NO_KEYBOARD
+/* timeout 0 checks endpoint once without waiting */
+static bool keyboard_write(report_keyboard_t *report, uint8_t timeout)
+{
     /* Select the Keyboard Report Endpoint */
 #if defined(NKRO_ENABLE) || defined(NKRO_6KRO_ENABLE)
     if (keyboard_protocol && keyboard_nkro) {
@@ -587,7 +787,7 @@ static void send_keyboard(report_keyboard_t *report)
 
         /* Check if write ready for a polling interval around 1ms */
         while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(8);
-        if (!Endpoint_IsReadWriteAllowed()) return;
+        if (!Endpoint_IsReadWriteAllowed()) return false;
 
         /* Write Keyboard Report Data */
         Endpoint_Write_Stream_LE(report, NKRO_EPSIZE, NULL);
@@ -600,7 +800,7 @@ static void send_keyboard(report_keyboard_t *report)
 
         /* Check if write ready for a polling interval around 10ms */
         while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(80);
-        if (!Endpoint_IsReadWriteAllowed()) return;
+        if (!Endpoint_IsReadWriteAllowed()) return false;
 
         /* Write Keyboard Report Data */
         Endpoint_Write_Stream_LE(report, KEYBOARD_EPSIZE, NULL);
@@ -610,44 +810,359 @@ static void send_keyboard(report_keyboard_t *report)
     Endpoint_ClearIN();
 
     keyboard_report_sent = *report;
+    return true;
+}
+
+#ifdef REPORT_QUEUE_SIZE
+static report_keyboard_t keyboard_queue[REPORT_QUEUE_SIZE];
+/* tag of latency trace for endpoint stage of key event */
+static uint8_t keyboard_queue_trace[REPORT_QUEUE_SIZE];
+static uint8_t keyboard_queue_head = 0;
+
+/* Strokes lost when newest report is replaced, each is sent again as two
+ * reports toggling the key on top of the newest one. Keycode or STROKE_MOD
+ * with bit of modifier. */
+#define STROKE_QUEUE_SIZE   8
+#define STROKE_MOD          0x100
+static uint16_t stroke_queue[STROKE_QUEUE_SIZE];
+static uint8_t stroke_queue_head = 0;
+static uint8_t stroke_queue_depth = 0;
+
+static void stroke_put(uint16_t stroke)
+{
+    if (stroke_queue_depth == STROKE_QUEUE_SIZE) {
+        queue_drop(&queue_stat[REPORT_QUEUE_KEYBOARD]);
+        return;
+    }
+    stroke_queue[(stroke_queue_head + stroke_queue_depth) & (STROKE_QUEUE_SIZE - 1)] = stroke;
+    stroke_queue_depth++;
 }
+
+/* records press or release of a lost when b replaces it, l is the one before a */
+static void keyboard_collapse(report_keyboard_t *l, report_keyboard_t *a, report_keyboard_t *b)
+{
+    uint8_t mods = (a->mods & ~l->mods & ~b->mods) | (l->mods & ~a->mods & b->mods);
+    for (uint8_t i = 0; i < 8; i++) {
+        if (mods & (1<<i)) stroke_put(STROKE_MOD | (1<<i));
+    }
+#if defined(NKRO_ENABLE) || defined(NKRO_6KRO_ENABLE)
+    if (keyboard_protocol && keyboard_nkro) {
+        for (uint8_t i = 0; i < KEYBOARD_REPORT_BITS; i++) {
+            uint8_t bits = (a->nkro.bits[i] & ~l->nkro.bits[i] & ~b->nkro.bits[i]) |
+                           (l->nkro.bits[i] & ~a->nkro.bits[i] & b->nkro.bits[i]);
+            for (uint8_t j = 0; j < 8; j++) {
+                if (bits & (1<<j)) stroke_put(i<<3 | j);
+            }
+        }
+        return;
+    }
 #endif
+    // key pressed with modifiers of a is sent with those of b, not counted
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        uint8_t code = a->keys[i];
+        if (code && !host_keyboard_has_key(l, code) && !host_keyboard_has_key(b, code)) {
+            stroke_put(code);
+        }
+        code = l->keys[i];
+        if (code && !host_keyboard_has_key(a, code) && host_keyboard_has_key(b, code)) {
+            stroke_put(code);
+        }
+    }
+}
 
-static void send_mouse(report_mouse_t *report)
+/* false when the key doesn't fit in report */
+static bool keyboard_toggle(report_keyboard_t *r, uint16_t stroke)
 {
-#ifdef MOUSE_ENABLE
-    uint8_t timeout = 255;
+    if (stroke & STROKE_MOD) {
+        r->mods ^= (uint8_t)stroke;
+        return true;
+    }
+    uint8_t code = stroke;
+#if defined(NKRO_ENABLE) || defined(NKRO_6KRO_ENABLE)
+    if (keyboard_protocol && keyboard_nkro) {
+        if ((code>>3) >= KEYBOARD_REPORT_BITS) return false;
+        r->nkro.bits[code>>3] ^= 1<<(code&7);
+        return true;
+    }
+#endif
+    uint8_t empty = KEYBOARD_REPORT_KEYS;
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (r->keys[i] == code) {
+            r->keys[i] = 0;
+            return true;
+        }
+        if (!r->keys[i] && empty == KEYBOARD_REPORT_KEYS) empty = i;
+    }
+    if (empty == KEYBOARD_REPORT_KEYS) return false;
+    r->keys[empty] = code;
+    return true;
+}
 
-    if (USB_DeviceState != DEVICE_STATE_Configured)
+/* recorded strokes are queued after newest report, or last one sent when empty */
+static void keyboard_queue_resend(void)
+{
+    report_queue_stat_t *stat = &queue_stat[REPORT_QUEUE_KEYBOARD];
+    while (stroke_queue_depth && stat->depth <= REPORT_QUEUE_SIZE - 2) {
+        uint16_t stroke = stroke_queue[stroke_queue_head];
+        stroke_queue_head = (stroke_queue_head + 1) & (STROKE_QUEUE_SIZE - 1);
+        stroke_queue_depth--;
+
+        report_keyboard_t last = keyboard_queue[QUEUE_INDEX(keyboard_queue_head + stat->depth + REPORT_QUEUE_SIZE - 1)];
+        report_keyboard_t r = last;
+        if (!keyboard_toggle(&r, stroke)) {
+            queue_drop(stat);
+            continue;
+        }
+        bool full;
+        uint8_t i = queue_put(stat, keyboard_queue_head, &full);
+        keyboard_queue[i] = r;
+        keyboard_queue_trace[i] = 0;
+        i = queue_put(stat, keyboard_queue_head, &full);
+        keyboard_queue[i] = last;
+        keyboard_queue_trace[i] = 0;
+    }
+}
+
+static void keyboard_queue_write(void)
+{
+    report_queue_stat_t *stat = &queue_stat[REPORT_QUEUE_KEYBOARD];
+    while (stat->depth && keyboard_write(&keyboard_queue[keyboard_queue_head], 0)) {
+        LATENCY_TRACE_DONE(keyboard_queue_trace[keyboard_queue_head]);
+        keyboard_queue_head = QUEUE_INDEX(keyboard_queue_head + 1);
+        stat->depth--;
+    }
+}
+
+static void keyboard_queue_flush(void)
+{
+    keyboard_queue_write();
+    if (stroke_queue_depth) {
+        keyboard_queue_resend();
+        keyboard_queue_write();
+    }
+}
+
+static uint8_t keyboard_pending(void)
+{
+    return queue_stat[REPORT_QUEUE_KEYBOARD].depth + stroke_queue_depth;
+}
+#endif
+
+static void send_keyboard(report_keyboard_t *report)
+{
+    if (USB_DeviceState != DEVICE_STATE_Configured) {
+        host_reports_lost();
         return;
+    }
 
-    /* Select the Mouse Report Endpoint */
+#ifdef REPORT_QUEUE_SIZE
+    report_queue_stat_t *stat = &queue_stat[REPORT_QUEUE_KEYBOARD];
+    keyboard_queue_flush();
+    if (stat->depth == REPORT_QUEUE_SIZE) {
+        // newest one is replaced without waiting for endpoint, strokes lost
+        // are sent again later. Replaced report keeps its tag and endpoint
+        // time of the earlier event is taken
+        uint8_t n = QUEUE_INDEX(keyboard_queue_head + REPORT_QUEUE_SIZE - 1);
+        report_keyboard_t *l = &keyboard_queue[QUEUE_INDEX(n + REPORT_QUEUE_SIZE - 1)];
+        if (!host_keyboard_mergeable(l, &keyboard_queue[n], report)) {
+            keyboard_collapse(l, &keyboard_queue[n], report);
+        }
+        keyboard_queue[n] = *report;
+        queue_merge(stat);
+        return;
+    }
+    bool full;
+    uint8_t i = queue_put(stat, keyboard_queue_head, &full);
+    keyboard_queue[i] = *report;
+    keyboard_queue_trace[i] = LATENCY_TRACE_DEFER(LATENCY_TRACE_ENDPOINT);
+    keyboard_queue_flush();
+#else
+    if (keyboard_write(report, 128)) {
+        LATENCY_TRACE(LATENCY_TRACE_ENDPOINT);
+    } else {
+        host_reports_lost();
+    }
+#endif
+}
+#endif
+
+#if defined(MOUSE_ENABLE) || defined(EXTRAKEY_ENABLE)
+static bool mouse_write(const void *data, uint8_t len, uint8_t timeout)
+{
     Endpoint_SelectEndpoint(MOUSE_IN_EPNUM);
 
     /* Check if write ready for a polling interval around 10ms */
     while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
-    if (!Endpoint_IsReadWriteAllowed()) return;
+    if (!Endpoint_IsReadWriteAllowed()) return false;
 
-    /* Write Mouse Report Data */
-    if (mouse_protocol) {
-        // Report
-        Endpoint_Write_8(REPORT_ID_MOUSE);
-        Endpoint_Write_Stream_LE(report, sizeof(report_mouse_t), NULL);
-    } else {
-        // Boot
-        Endpoint_Write_Stream_LE(report, 3, NULL);
-    }
+    Endpoint_Write_Stream_LE(data, len, NULL);
 
     /* Finalize the stream transfer to send the last packet */
     Endpoint_ClearIN();
+    return true;
+}
 #endif
+
+#if defined(MOUSE_ENABLE) && defined(REPORT_QUEUE_SIZE)
+/* mouse report and protocol it is sent with */
+typedef struct {
+    bool boot;
+    report_mouse_t report;
+} mouse_entry_t;
+
+static mouse_entry_t mouse_queue[REPORT_QUEUE_SIZE];
+static uint8_t mouse_queue_head = 0;
+
+static int8_t add_int8(int8_t a, int8_t b)
+{
+    int16_t v = a + b;
+    return (v > 127) ? 127 : ((v < -127) ? -127 : v);
 }
 
-static void send_system(uint16_t data)
+#ifdef MOUSE_EXT_REPORT
+static int16_t add_int16(int16_t a, int16_t b)
+{
+    int32_t v = (int32_t)a + b;
+    return (v > 32767) ? 32767 : ((v < -32767) ? -32767 : v);
+}
+#endif
+
+/* movement is added and buttons are taken from new report */
+static void mouse_merge(report_mouse_t *r, const report_mouse_t *n)
+{
+    r->buttons = n->buttons;
+#ifdef MOUSE_EXT_REPORT
+    r->boot_x = add_int8(r->boot_x, n->boot_x);
+    r->boot_y = add_int8(r->boot_y, n->boot_y);
+    r->x = add_int16(r->x, n->x);
+    r->y = add_int16(r->y, n->y);
+#else
+    r->x = add_int8(r->x, n->x);
+    r->y = add_int8(r->y, n->y);
+#endif
+    r->v = add_int8(r->v, n->v);
+    r->h = add_int8(r->h, n->h);
+}
+#endif
+
+#ifdef MOUSE_ENABLE
+static bool mouse_report_write(bool boot, report_mouse_t *report, uint8_t timeout)
+{
+    if (boot) {
+        return mouse_write(report, 3, timeout);
+    }
+    uint8_t data[1 + sizeof(report_mouse_t)];
+    data[0] = REPORT_ID_MOUSE;
+    memcpy(&data[1], report, sizeof(report_mouse_t));
+    return mouse_write(data, sizeof(data), timeout);
+}
+#endif
+
+#if defined(EXTRAKEY_ENABLE) && defined(REPORT_QUEUE_SIZE)
+static report_extra_t extra_queue[REPORT_QUEUE_SIZE];
+static uint8_t extra_queue_head = 0;
+
+/* latest report of each ID waiting for room, system and consumer */
+static report_extra_t extra_waiting[2];
+static uint8_t extra_waiting_ids = 0;
+
+/* waiting ones are queued when there is room */
+static void extra_queue_unwait(void)
+{
+    report_queue_stat_t *stat = &queue_stat[REPORT_QUEUE_EXTRA];
+    for (uint8_t n = 0; n < 2; n++) {
+        if (!(extra_waiting_ids & (1<<n)) || stat->depth == REPORT_QUEUE_SIZE) continue;
+        bool full;
+        extra_queue[queue_put(stat, extra_queue_head, &full)] = extra_waiting[n];
+        extra_waiting_ids &= ~(1<<n);
+    }
+}
+
+static void extra_queue_put(report_extra_t *r)
+{
+    report_queue_stat_t *stat = &queue_stat[REPORT_QUEUE_EXTRA];
+    extra_queue_unwait();
+    if (stat->depth == REPORT_QUEUE_SIZE) {
+        /* queued ones have press or release of usage and are kept,
+         * new one replaces waiting one of the same ID and its stroke is lost */
+        uint8_t n = (r->report_id == REPORT_ID_CONSUMER);
+        if (extra_waiting_ids & (1<<n)) queue_drop(stat);
+        extra_waiting[n] = *r;
+        extra_waiting_ids |= (1<<n);
+        return;
+    }
+    bool full;
+    extra_queue[queue_put(stat, extra_queue_head, &full)] = *r;
+}
+#endif
+
+#if defined(REPORT_QUEUE_SIZE) && (defined(MOUSE_ENABLE) || defined(EXTRAKEY_ENABLE))
+static void mouse_queue_flush(void)
 {
 #ifdef EXTRAKEY_ENABLE
-    uint8_t timeout = 255;
+    report_queue_stat_t *extra = &queue_stat[REPORT_QUEUE_EXTRA];
+    while (extra->depth && mouse_write(&extra_queue[extra_queue_head], sizeof(report_extra_t), 0)) {
+        extra_queue_head = QUEUE_INDEX(extra_queue_head + 1);
+        extra->depth--;
+        extra_queue_unwait();
+    }
+    if (extra->depth) return;
+#endif
+#ifdef MOUSE_ENABLE
+    report_queue_stat_t *stat = &queue_stat[REPORT_QUEUE_MOUSE];
+    while (stat->depth && mouse_report_write(mouse_queue[mouse_queue_head].boot,
+                                             &mouse_queue[mouse_queue_head].report, 0)) {
+        mouse_queue_head = QUEUE_INDEX(mouse_queue_head + 1);
+        stat->depth--;
+    }
+#endif
+}
+#endif
+
+static void send_mouse(report_mouse_t *report)
+{
+#ifdef MOUSE_ENABLE
+    if (USB_DeviceState != DEVICE_STATE_Configured) {
+        host_reports_lost();
+        return;
+    }
 
+#ifdef REPORT_QUEUE_SIZE
+    bool full;
+    uint8_t i = queue_put(&queue_stat[REPORT_QUEUE_MOUSE], mouse_queue_head, &full);
+    // newest one is replaced only when protocol has changed
+    if (full && mouse_queue[i].boot == !mouse_protocol) {
+        mouse_merge(&mouse_queue[i].report, report);
+        queue_merge(&queue_stat[REPORT_QUEUE_MOUSE]);
+    } else {
+        if (full) queue_drop(&queue_stat[REPORT_QUEUE_MOUSE]);
+        mouse_queue[i].boot = !mouse_protocol;
+        mouse_queue[i].report = *report;
+    }
+    mouse_queue_flush();
+#else
+    if (!mouse_report_write(!mouse_protocol, report, 255)) {
+        host_reports_lost();
+    }
+#endif
+#endif
+}
+
+#ifdef EXTRAKEY_ENABLE
+static void send_extra(report_extra_t *r)
+{
+#ifdef REPORT_QUEUE_SIZE
+    extra_queue_put(r);
+    mouse_queue_flush();
+#else
+    mouse_write(r, sizeof(report_extra_t), 255);
+#endif
+}
+#endif
+
+static void send_system(uint16_t data)
+{
+#ifdef EXTRAKEY_ENABLE
     if (USB_DeviceState != DEVICE_STATE_Configured)
         return;
 
@@ -663,22 +1178,13 @@ static void send_system(uint16_t data)
     } else {
         r.usage = data - SYSTEM_POWER_DOWN + 1;
     }
-    Endpoint_SelectEndpoint(MOUSE_IN_EPNUM);
-
-    /* Check if write ready for a polling interval around 10ms */
-    while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
-    if (!Endpoint_IsReadWriteAllowed()) return;
-
-    Endpoint_Write_Stream_LE(&r, sizeof(report_extra_t), NULL);
-    Endpoint_ClearIN();
+    send_extra(&r);
 #endif
 }
 
 static void send_consumer(uint16_t data)
 {
 #ifdef EXTRAKEY_ENABLE
-    uint8_t timeout = 255;
-
     if (USB_DeviceState != DEVICE_STATE_Configured)
         return;
 
@@ -692,16 +1198,50 @@ static void send_consumer(uint16_t data)
         .report_id = REPORT_ID_CONSUMER,
         .usage = data
     };
-    Endpoint_SelectEndpoint(MOUSE_IN_EPNUM);
+    send_extra(&r);
+#endif
+}
 
-    /* Check if write ready for a polling interval around 10ms */
-    while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
-    if (!Endpoint_IsReadWriteAllowed()) return;
+#ifdef REPORT_QUEUE_SIZE
+void lufa_report_queue_task(void)
+{
+    if (USB_DeviceState != DEVICE_STATE_Configured) {
+        /* reports queued before suspend or reset are not sent */
+#ifndef NO_KEYBOARD
+        for (uint8_t n = 0; n < queue_stat[REPORT_QUEUE_KEYBOARD].depth; n++) {
+            LATENCY_TRACE_CANCEL(keyboard_queue_trace[QUEUE_INDEX(keyboard_queue_head + n)]);
+        }
+#endif
+        for (uint8_t i = 0; i < REPORT_QUEUE_NUM; i++) {
+            report_queue_stat_t *stat = &queue_stat[i];
+            if (!stat->depth) continue;
+            stat->drop = (UINT16_MAX - stat->drop < stat->depth) ? UINT16_MAX : stat->drop + stat->depth;
+            stat->depth = 0;
+            host_reports_lost();
+        }
+#ifndef NO_KEYBOARD
+        while (stroke_queue_depth) {
+            queue_drop(&queue_stat[REPORT_QUEUE_KEYBOARD]);
+            stroke_queue_depth--;
+        }
+#endif
+#ifdef EXTRAKEY_ENABLE
+        for (uint8_t n = 0; n < 2; n++) {
+            if (extra_waiting_ids & (1<<n)) queue_drop(&queue_stat[REPORT_QUEUE_EXTRA]);
+        }
+        extra_waiting_ids = 0;
+#endif
+        return;
+    }
 
-    Endpoint_Write_Stream_LE(&r, sizeof(report_extra_t), NULL);
-    Endpoint_ClearIN();
+#ifndef NO_KEYBOARD
+    keyboard_queue_flush();
+#endif
+#if defined(MOUSE_ENABLE) || defined(EXTRAKEY_ENABLE)
+    mouse_queue_flush();
 #endif
 }
+#endif
 
 
 /*******************************************************************************
@@ -821,16 +1361,30 @@ int main(void)
         hook_main_loop();
 
 #ifndef NO_KEYBOARD
+#ifdef SOF_SCAN_PHASE
+        sof_scan_wait();
+#endif
         keyboard_task();
+#ifdef SOF_SCAN_PHASE
+        sof_scan_done();
+#endif
+#endif
+
+#ifdef REPORT_QUEUE_SIZE
+        lufa_report_queue_task();
 #endif
 
 #ifdef CONSOLE_ENABLE
-        console_task();
+        lufa_console_task();
 #endif
 
 #if !defined(INTERRUPT_CONTROL_ENDPOINT)
         USB_USBTask();
 #endif
+
+#ifdef IDLE_SLEEP_ENABLE
+        idle_sleep_task();
+#endif
     }
 }
 
@@ -56,6 +56,32 @@ extern "C" {
 
 extern host_driver_t lufa_driver;
 
+#ifdef REPORT_QUEUE_SIZE
+enum {
+    REPORT_QUEUE_KEYBOARD = 0,
+    REPORT_QUEUE_MOUSE,
+    REPORT_QUEUE_EXTRA,     /* system and consumer */
+    REPORT_QUEUE_NUM
+};
+
+typedef struct {
+    uint8_t  depth;         /* reports waiting for endpoint */
+    uint8_t  max;           /* high water mark of depth */
+    uint16_t merge;         /* reports put together with queued one */
+    uint16_t drop;          /* strokes not sent to host */
+} report_queue_stat_t;
+
+/* write queued reports to endpoints, call from main loop */
+void lufa_report_queue_task(void);
+const report_queue_stat_t *lufa_report_queue_stat(uint8_t queue);
+void lufa_report_queue_clear_stat(void);
+#endif
+
+#ifdef CONSOLE_ENABLE
+/* send console buffer once a frame, call from main loop */
+void lufa_console_task(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
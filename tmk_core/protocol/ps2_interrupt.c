@@ -42,7 +42,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <stdbool.h>
 #include <avr/interrupt.h>
 #include <util/delay.h>
-#include "pbuff.h"
+#include "spsc_ring.h"
 #include "ps2.h"
 #include "ps2_io.h"
 #include "print.h"
@@ -58,6 +58,11 @@ POSSIBILITY OF SUCH DAMAGE.
 
 uint8_t ps2_error = PS2_ERR_NONE;
 
+/* scan codes from ISR */
+#define PBUF_SIZE 32
+SPSC_RING_DEFINE(ps2_buf, uint8_t, PBUF_SIZE)
+static ps2_buf_t pbuf;
+
 void ps2_host_init(void)
 {
     idle();
@@ -127,18 +132,20 @@ uint8_t ps2_host_recv_response(void)
 {
     // Command may take 25ms/20ms at most([5]p.46, [3]p.21)
     uint8_t retry = 25;
-    while (retry-- && !pbuf_has_data()) {
+    uint8_t data = 0;
+    while (retry-- && !ps2_buf_get(&pbuf, &data)) {
         _delay_ms(1);
     }
-    return pbuf_dequeue();
+    return data;
 }
 
 /* get data received by interrupt */
 uint8_t ps2_host_recv(void)
 {
-    if (pbuf_has_data()) {
+    uint8_t data;
+    if (ps2_buf_get(&pbuf, &data)) {
         ps2_error = PS2_ERR_NONE;
-        return pbuf_dequeue();
+        return data;
     } else {
         ps2_error = PS2_ERR_NODATA;
         return 0;
@@ -196,7 +203,9 @@ ISR(PS2_INT_VECT)
         case STOP:
             if (!data_in())
                 goto ERROR;
-            pbuf_enqueue(data);
+            if (!ps2_buf_put(&pbuf, data)) {
+                print("pbuf: full\n");
+            }
             goto DONE;
             break;
         default:
@@ -71,13 +71,15 @@ static void send_keyboard(report_keyboard_t *report);
 static void send_mouse(report_mouse_t *report);
 static void send_system(uint16_t data);
 static void send_consumer(uint16_t data);
+static uint8_t keyboard_pending(void);
 
 static host_driver_t driver = {
         keyboard_leds,
         send_keyboard,
         send_mouse,
         send_system,
-        send_consumer
+        send_consumer,
+        keyboard_pending
 };
 
 host_driver_t *vusb_driver(void)
@@ -104,6 +106,11 @@ static void send_keyboard(report_keyboard_t *report)
     vusb_transfer_keyboard();
 }
 
+static uint8_t keyboard_pending(void)
+{
+    return (kbuf_head + KBUF_SIZE - kbuf_tail) % KBUF_SIZE;
+}
+
 
 typedef struct {
     uint8_t report_id;
@@ -42,17 +42,12 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "xt.h"
 #include "wait.h"
 #include "print.h"
-#include "ringbuf.h"
+#include "spsc_ring.h"
 
 
 #define BUF_SIZE 16
-static uint8_t buf[BUF_SIZE];
-static ringbuf_t rb = {
-    .buffer = buf,
-    .head = 0,
-    .tail = 0,
-    .size_mask = BUF_SIZE - 1
-};
+SPSC_RING_DEFINE(xt_buf, uint8_t, BUF_SIZE)
+static xt_buf_t rb;
 
 void xt_host_init(void)
 {
@@ -79,10 +74,10 @@ void xt_host_init(void)
 /* get data received by interrupt */
 uint8_t xt_host_recv(void)
 {
-    if (ringbuf_is_empty(&rb)) {
+    uint8_t d;
+    if (!xt_buf_get(&rb, &d)) {
         return 0;
     } else {
-        int16_t d = ringbuf_get(&rb);
         XT_DATA_IN();  // ready to receive from keyboard
         return d;
     }
@@ -123,8 +118,8 @@ ISR(XT_INT_VECT)
             break;
     }
     if (state++ == BIT7) {
-        ringbuf_put(&rb, data);
-        if (ringbuf_is_full(&rb)) {
+        xt_buf_put(&rb, data);
+        if (xt_buf_is_full(&rb)) {
             XT_DATA_LO();  // inhibit keyboard sending
             print("Full");
         }
@@ -1,6 +1,7 @@
 COMMON_DIR = $(TMK_DIR)/common
 SRC +=	$(COMMON_DIR)/host.c \
 	$(COMMON_DIR)/keyboard.c \
+	$(COMMON_DIR)/debounce.c \
 	$(COMMON_DIR)/action.c \
 	$(COMMON_DIR)/action_tapping.c \
 	$(COMMON_DIR)/action_macro.c \
@@ -46,6 +47,19 @@ ifdef COMMAND_ENABLE
     OPT_DEFS += -DCOMMAND_ENABLE
 endif
 
+ifdef LATENCY_TRACE_ENABLE
+    SRC += $(COMMON_DIR)/latency_trace.c
+    OPT_DEFS += -DLATENCY_TRACE_ENABLE
+endif
+
+ifdef LAYER_CACHE_ENABLE
+    OPT_DEFS += -DLAYER_CACHE_ENABLE
+endif
+
+ifdef REPORT_INDEX_ENABLE
+    OPT_DEFS += -DREPORT_INDEX_ENABLE
+endif
+
 ifdef NKRO_ENABLE
     OPT_DEFS += -DNKRO_ENABLE
 endif
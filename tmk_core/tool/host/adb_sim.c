@@ -0,0 +1,152 @@
+/*
+ * Waveform simulator of ADB bus for decoder of protocol/adb_timer.c
+ *
+ *      adb_sim [-j us] [timing]
+ *
+ * Reads timing of data line captured with logic analyzer from file or stdin
+ * and decodes it with adb_frame.h as the firmware does. Each line is level
+ * and its duration in microseconds, '#' starts comment.
+ *
+ *      # attention and start bit, command 2C
+ *      L 800
+ *      H 65
+ *      L 65
+ *      H 35
+ *      ...
+ *
+ * Command frames begin with attention(low 560us or longer) and the rest are
+ * data frames. Stop bit of command longer than cell is Service Request. A
+ * frame ends when line stays high longer than cell(130us).
+ *
+ * -j adds random delay up to this to every edge like latency of ISR.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include "adb_frame.h"
+
+#define CELL_MAX        130
+#define ATTENTION_MIN   560
+#define RESET_MIN       2800
+
+
+static int jitter = 0;
+
+static adb_frame_t frame;
+static uint8_t buf[8];
+static bool in_frame = false;
+static bool is_command = false;
+static bool srq = false;
+static uint32_t frame_start;
+
+
+static uint16_t edge_time(uint32_t t)
+{
+    return (uint16_t)(t + (jitter ? rand() % (jitter + 1) : 0));
+}
+
+static void end_frame(void)
+{
+    uint8_t n = adb_frame_bytes(&frame);
+    if (is_command) {
+        static const char *type[] = { "Reset", "Flush", "Reserved", "Reserved",
+                                      "Reserved", "Reserved", "Reserved", "Reserved",
+                                      "Listen", "Listen", "Listen", "Listen",
+                                      "Talk", "Talk", "Talk", "Talk" };
+        if (n != 1) {
+            printf("%8u cmd: broken(%u bytes)%s\n", frame_start, n, srq ? " SRQ" : "");
+        } else {
+            printf("%8u cmd: %02X %s $%X:%u%s\n", frame_start, buf[0],
+                   type[buf[0] & 0x0F], buf[0] >> 4, buf[0] & 0x03, srq ? " SRQ" : "");
+        }
+    } else {
+        printf("%8u data:", frame_start);
+        for (uint8_t i = 0; i < n && i < sizeof(buf); i++) printf(" %02X", buf[i]);
+        if (n > sizeof(buf)) printf(" ...(%u bytes)", n);
+        printf("\n");
+    }
+    in_frame = false;
+}
+
+static void simulate(FILE *in)
+{
+    char line[256];
+    uint32_t t = 0;
+    int lineno = 0;
+    while (fgets(line, sizeof(line), in)) {
+        lineno++;
+        char *p = strchr(line, '#');
+        if (p) *p = '\0';
+
+        char level;
+        unsigned dur;
+        if (sscanf(line, " %c %u", &level, &dur) != 2) continue;
+        if (level != 'L' && level != 'H') {
+            fprintf(stderr, "%d: level must be L or H\n", lineno);
+            exit(2);
+        }
+
+        if (level == 'L') {
+            if (dur >= RESET_MIN) {
+                if (in_frame) end_frame();
+                printf("%8u reset: %uus\n", t, dur);
+            } else if (dur >= ATTENTION_MIN) {
+                // attention and start bit make first cell of command
+                if (in_frame) end_frame();
+                adb_frame_init(&frame, buf, sizeof(buf));
+                adb_frame_fall(&frame, edge_time(t));
+                in_frame = true;
+                is_command = true;
+                srq = false;
+                frame_start = t;
+            } else if (in_frame && dur > CELL_MAX) {
+                // device holds stop bit of command
+                srq = is_command;
+                adb_frame_fall(&frame, edge_time(t));
+            } else {
+                if (!in_frame) {
+                    adb_frame_init(&frame, buf, sizeof(buf));
+                    in_frame = true;
+                    is_command = false;
+                    frame_start = t;
+                }
+                adb_frame_fall(&frame, edge_time(t));
+            }
+        } else {
+            if (in_frame) {
+                adb_frame_rise(&frame, edge_time(t));
+                if (dur > CELL_MAX) end_frame();
+            }
+        }
+        t += dur;
+    }
+    if (in_frame) end_frame();
+}
+
+
+int main(int argc, char *argv[])
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "j:")) != -1) {
+        switch (opt) {
+            case 'j':
+                jitter = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-j us] [timing]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    FILE *in = stdin;
+    if (optind < argc && !(in = fopen(argv[optind], "r"))) {
+        perror(argv[optind]);
+        return 1;
+    }
+    srand(1);
+    simulate(in);
+    return 0;
+}
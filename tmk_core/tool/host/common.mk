@@ -0,0 +1,117 @@
+COMMON_DIR = $(TMK_DIR)/common
+SRC +=	$(COMMON_DIR)/host.c \
+	$(COMMON_DIR)/keyboard.c \
+	$(COMMON_DIR)/matrix.c \
+	$(COMMON_DIR)/debounce.c \
+	$(COMMON_DIR)/action.c \
+	$(COMMON_DIR)/action_tapping.c \
+	$(COMMON_DIR)/action_macro.c \
+	$(COMMON_DIR)/action_layer.c \
+	$(COMMON_DIR)/action_util.c \
+	$(COMMON_DIR)/print.c \
+	$(COMMON_DIR)/debug.c \
+	$(COMMON_DIR)/util.c \
+	$(COMMON_DIR)/hook.c \
+	$(COMMON_DIR)/mouse.c \
+	$(COMMON_DIR)/host/suspend.c \
+	$(COMMON_DIR)/host/xprintf.c \
+	$(COMMON_DIR)/host/timer.c \
+	$(COMMON_DIR)/host/bootloader.c
+
+# replay harness: virtual matrix, mock host driver and main()
+SRC +=	$(TMK_DIR)/tool/host/replay.c
+
+
+ifeq (yes,$(strip $(UNIMAP_ENABLE)))
+    SRC += $(COMMON_DIR)/unimap.c
+    OPT_DEFS += -DUNIMAP_ENABLE
+    OPT_DEFS += -DACTIONMAP_ENABLE
+else
+    ifeq (yes,$(strip $(ACTIONMAP_ENABLE)))
+	SRC += $(COMMON_DIR)/actionmap.c
+	OPT_DEFS += -DACTIONMAP_ENABLE
+    else
+	SRC += $(COMMON_DIR)/keymap.c
+    endif
+endif
+
+# Option modules
+ifeq (yes,$(strip $(BOOTMAGIC_ENABLE)))
+    $(error Not Supported)
+endif
+
+ifeq (yes,$(strip $(MOUSEKEY_ENABLE)))
+    SRC += $(COMMON_DIR)/mousekey.c
+    OPT_DEFS += -DMOUSEKEY_ENABLE
+    OPT_DEFS += -DMOUSE_ENABLE
+endif
+
+ifeq (yes,$(strip $(EXTRAKEY_ENABLE)))
+    OPT_DEFS += -DEXTRAKEY_ENABLE
+endif
+
+ifeq (yes,$(strip $(CONSOLE_ENABLE)))
+    OPT_DEFS += -DCONSOLE_ENABLE
+else
+    OPT_DEFS += -DNO_PRINT
+    OPT_DEFS += -DNO_DEBUG
+endif
+
+ifeq (yes,$(strip $(COMMAND_ENABLE)))
+    SRC += $(COMMON_DIR)/command.c
+    OPT_DEFS += -DCOMMAND_ENABLE
+endif
+
+ifeq (yes,$(strip $(LATENCY_TRACE_ENABLE)))
+    SRC += $(COMMON_DIR)/latency_trace.c
+    OPT_DEFS += -DLATENCY_TRACE_ENABLE
+endif
+
+ifdef KEYMAP_COMPILED
+    SRC += $(COMMON_DIR)/keymap_compiled.c
+    OPT_DEFS += -DKEYMAP_COMPILED_ENABLE
+    OPT_DEFS += -DKEYMAP_COMPILED=\"$(abspath $(KEYMAP_COMPILED))\"
+endif
+
+ifeq (yes,$(strip $(TLOG_ENABLE)))
+    SRC += $(COMMON_DIR)/tlog.c
+    OPT_DEFS += -DTLOG_ENABLE
+endif
+
+ifeq (yes,$(strip $(LAYER_CACHE_ENABLE)))
+    OPT_DEFS += -DLAYER_CACHE_ENABLE
+endif
+
+ifeq (yes,$(strip $(REPORT_INDEX_ENABLE)))
+    OPT_DEFS += -DREPORT_INDEX_ENABLE
+endif
+
+ifeq (yes,$(strip $(NKRO_ENABLE)))
+    OPT_DEFS += -DNKRO_ENABLE
+endif
+
+ifeq (yes,$(strip $(USB_6KRO_ENABLE)))
+    OPT_DEFS += -DUSB_6KRO_ENABLE
+endif
+
+ifeq (yes,$(strip $(SLEEP_LED_ENABLE)))
+    $(error Not Supported)
+endif
+
+ifeq (yes,$(strip $(IDLE_SLEEP_ENABLE)))
+    $(error Not Supported)
+endif
+
+ifeq (yes,$(strip $(MATRIX_WAKE_ENABLE)))
+    $(error Not Supported)
+endif
+
+ifeq (yes,$(strip $(BACKLIGHT_ENABLE)))
+    $(error Not Supported)
+endif
+
+OPT_DEFS += -DPLATFORM_HOST
+
+# Version string
+TMK_VERSION := $(shell (git rev-parse --short=6 HEAD || echo 'unknown') 2> /dev/null)
+OPT_DEFS += -DTMK_VERSION=$(TMK_VERSION)
@@ -0,0 +1,103 @@
+# Native build for Linux host
+#
+# Links tmk_core with keymap of a project into an executable which replays
+# recorded key events. No MCU or USB stack is involved.
+
+CC      = gcc
+SIZE    = size
+
+OBJDIR ?= obj_$(TARGET)
+
+CFLAGS += \
+	-g \
+	-O2 \
+	-Wall \
+	-std=gnu99 \
+	-fno-common \
+	-funsigned-char \
+	-funsigned-bitfields
+CFLAGS += -MMD -MP
+CFLAGS += $(OPT_DEFS)
+CFLAGS += -include $(CONFIG_H)
+CFLAGS += -I$(TARGET_DIR) -I$(TMK_DIR)/common -I$(TMK_DIR)/protocol
+# You can give extra flags at 'make' command line like: make EXTRAFLAGS=-DFOO=bar
+CFLAGS += $(EXTRAFLAGS)
+
+OBJ = $(addprefix $(OBJDIR)/,$(patsubst $(TMK_DIR)/%,tmk_core/%,$(SRC:.c=.o)))
+
+
+all: $(OBJDIR)/$(TARGET)
+
+$(OBJDIR)/$(TARGET): $(OBJ)
+	$(CC) $(CFLAGS) -o $@ $^ $(LDFLAGS)
+	@$(SIZE) $@
+
+$(OBJDIR)/tmk_core/%.o: $(TMK_DIR)/%.c
+	@mkdir -p $(@D)
+	$(CC) -c $(CFLAGS) -o $@ $<
+
+$(OBJDIR)/%.o: %.c
+	@mkdir -p $(@D)
+	$(CC) -c $(CFLAGS) -o $@ $<
+
+# decoder of tokenized log, also for firmware of AVR
+tlog_decode: $(OBJDIR)/tlog_decode
+
+$(OBJDIR)/tlog_decode: $(TMK_DIR)/tool/host/tlog_decode.c
+	@mkdir -p $(@D)
+	$(CC) -g -O2 -Wall -std=gnu99 -o $@ $<
+
+# waveform simulator for decoder of ADB
+adb_sim: $(OBJDIR)/adb_sim
+
+$(OBJDIR)/adb_sim: $(TMK_DIR)/tool/host/adb_sim.c $(TMK_DIR)/protocol/adb_frame.h
+	@mkdir -p $(@D)
+	$(CC) -g -O2 -Wall -std=gnu99 -I$(TMK_DIR)/protocol -o $@ $<
+
+# analyzer of frames captured by IBMPC ISR
+ibmpc_capture: $(OBJDIR)/ibmpc_capture
+
+$(OBJDIR)/ibmpc_capture: $(TMK_DIR)/tool/host/ibmpc_capture.c
+	@mkdir -p $(@D)
+	$(CC) -g -O2 -Wall -std=gnu99 -o $@ $<
+
+# checks of tmk_core modules, exit status is 1 on failure
+check: latency_check spsc_check adb_sim_check
+
+latency_check: $(OBJDIR)/latency_check
+	$(OBJDIR)/latency_check
+
+LATENCY_CHECK_SRC = $(TMK_DIR)/tool/host/latency_check.c \
+	$(TMK_DIR)/common/latency_trace.c \
+	$(TMK_DIR)/common/util.c \
+	$(TMK_DIR)/common/print.c \
+	$(TMK_DIR)/common/host/xprintf.c \
+	$(TMK_DIR)/common/host/timer.c
+
+$(OBJDIR)/latency_check: $(LATENCY_CHECK_SRC)
+	@mkdir -p $(@D)
+	$(CC) -g -O2 -Wall -std=gnu99 -DPLATFORM_HOST -DLATENCY_TRACE_ENABLE -DLATENCY_TRACE_TICKS_PER_MS=251 \
+		-I$(TMK_DIR)/common -o $@ $(LATENCY_CHECK_SRC)
+
+# producer in SIGALRM handler against consumer in main loop
+spsc_check: $(OBJDIR)/spsc_check
+	$(OBJDIR)/spsc_check
+
+$(OBJDIR)/spsc_check: $(TMK_DIR)/tool/host/spsc_check.c $(TMK_DIR)/common/spsc_ring.h
+	@mkdir -p $(@D)
+	$(CC) -g -O2 -Wall -std=gnu99 -I$(TMK_DIR)/common -o $@ $<
+
+# decoder of ADB against waveform of command, SRQ, data and no response,
+# also with ISR latency
+ADB_WAVEFORM = $(TMK_DIR)/tool/host/trace/adb_waveform
+
+adb_sim_check: $(OBJDIR)/adb_sim
+	$(OBJDIR)/adb_sim $(ADB_WAVEFORM).txt | diff - $(ADB_WAVEFORM)_expected.txt
+	$(OBJDIR)/adb_sim -j 10 $(ADB_WAVEFORM).txt | diff - $(ADB_WAVEFORM)_expected.txt
+
+clean:
+	rm -fr $(OBJDIR)
+
+.PHONY: all clean tlog_decode adb_sim ibmpc_capture check latency_check spsc_check adb_sim_check
+
+-include $(OBJ:.o=.d)
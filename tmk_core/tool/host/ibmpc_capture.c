@@ -0,0 +1,289 @@
+/*
+ * Analyzer of frames captured by IBMPC ISR(protocol/ibmpc.hpp IBMPC_CAPTURE)
+ *
+ *      ibmpc_capture [-v] [-p] [-w us] [log]
+ *
+ * Reads console output from log file or stdin and prints counts of protocol
+ * and error, histogram of frame length from first to last clock edge and
+ * histogram of gap from end of frame to start of next one for each
+ * interface. Interface is told by its clock bit.
+ *
+ * -v prints every frame, -p passes text other than records to stdout and
+ * -w sets bucket width of length histogram, 250us by default.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#define IBMPC_CAPTURE_FRAME_START   0x02
+
+/* same as protocol/ibmpc.hpp */
+#define IBMPC_PROTOCOL_AT       0x10
+#define IBMPC_PROTOCOL_AT_Z150  0x11
+#define IBMPC_PROTOCOL_XT_IBM   0x21
+#define IBMPC_PROTOCOL_XT_CLONE 0x22
+
+#define IBMPC_ERR_PARITY      0x01
+#define IBMPC_ERR_PARITY_AA   0x02
+#define IBMPC_ERR_TIMEOUT     0x20
+#define IBMPC_ERR_FULL        0x40
+#define IBMPC_ERR_ILLEGAL     0x80
+
+/* clock_bit, TIMER_RAW_TOP and ibmpc_capture_t */
+#define RECORD_SIZE     13
+
+#define LENGTH_BUCKETS  64
+/* gap in power of 2 from 64us to 64s */
+#define GAP_MIN_LOG2    6
+#define GAP_BUCKETS     21
+
+#define INTERFACES      8
+
+
+typedef struct {
+    int seen;
+    uint32_t ms_hi;         // upper bits of millisecond timer
+    uint16_t ms_lo;
+    double last_end;        // us
+    int has_last;
+
+    unsigned long frames;
+    unsigned long lost;
+    unsigned long protocols[4];     // AT, AT_Z150, XT_IBM, XT_CLONE
+    unsigned long errors[5];        // PARITY, PARITY_AA, TIMEOUT, FULL, ILLEGAL
+    unsigned long length_ok[LENGTH_BUCKETS + 1];
+    unsigned long length_err[LENGTH_BUCKETS + 1];
+    unsigned long gap[GAP_BUCKETS + 1];
+    double length_max_ok;
+    double gap_min;
+} interface_t;
+
+static interface_t ifs[INTERFACES];
+static int verbose = 0;
+static int passthrough = 0;
+static unsigned bucket_us = 250;
+static unsigned long broken = 0;
+
+
+static const char *protocol_str(uint8_t p)
+{
+    switch (p) {
+        case IBMPC_PROTOCOL_AT:       return "AT";
+        case IBMPC_PROTOCOL_AT_Z150:  return "AT_Z150";
+        case IBMPC_PROTOCOL_XT_IBM:   return "XT_IBM";
+        case IBMPC_PROTOCOL_XT_CLONE: return "XT_CLONE";
+        default:                      return "-";
+    }
+}
+
+static const char *error_str(uint8_t e)
+{
+    switch (e) {
+        case 0:                   return "";
+        case IBMPC_ERR_PARITY:    return "PARITY";
+        case IBMPC_ERR_PARITY_AA: return "PARITY_AA";
+        case IBMPC_ERR_TIMEOUT:   return "TIMEOUT";
+        case IBMPC_ERR_FULL:      return "FULL";
+        case IBMPC_ERR_ILLEGAL:   return "ILLEGAL";
+        default:                  return "?";
+    }
+}
+
+/* returns length decoded or -1 on error */
+static int cobs_decode(const uint8_t *in, int len, uint8_t *out)
+{
+    int n = 0;
+    for (int i = 0; i < len; ) {
+        uint8_t code = in[i++];
+        if (code == 0 || i + code - 1 > len) return -1;
+        for (int k = 1; k < code; k++) out[n++] = in[i++];
+        if (i < len) out[n++] = 0;
+    }
+    return n;
+}
+
+static void record(const uint8_t *rec)
+{
+    uint8_t clock_bit  = rec[0];
+    uint8_t top        = rec[1];
+    uint16_t start_ms  = rec[2] | (rec[3] << 8);
+    uint8_t start_tick = rec[4];
+    uint8_t end_ms     = rec[5];
+    uint8_t end_tick   = rec[6];
+    uint16_t state     = rec[7] | (rec[8] << 8);
+    uint8_t protocol   = rec[9];
+    uint8_t error      = rec[10];
+    uint8_t data       = rec[11];
+    uint8_t lost       = rec[12];
+
+    if (clock_bit >= INTERFACES || top == 0) { broken++; return; }
+    interface_t *f = &ifs[clock_bit];
+
+    /* millisecond timer goes TIMER_RAW_TOP+1 ticks of TIMER_RAW_TOP kHz */
+    if (f->seen && start_ms < f->ms_lo) f->ms_hi++;
+    f->ms_lo = start_ms;
+    f->seen = 1;
+    uint64_t start_abs = ((uint64_t)f->ms_hi << 16) | start_ms;
+    uint64_t end_abs = start_abs + (uint8_t)(end_ms - (uint8_t)start_ms);
+    double start = (start_abs * (top + 1) + start_tick) * 1000.0 / top;
+    double end   = (end_abs   * (top + 1) + end_tick)   * 1000.0 / top;
+    double length = end - start;
+
+    f->frames++;
+    f->lost += lost;
+    switch (protocol) {
+        case IBMPC_PROTOCOL_AT:       f->protocols[0]++; break;
+        case IBMPC_PROTOCOL_AT_Z150:  f->protocols[1]++; break;
+        case IBMPC_PROTOCOL_XT_IBM:   f->protocols[2]++; break;
+        case IBMPC_PROTOCOL_XT_CLONE: f->protocols[3]++; break;
+    }
+    switch (error) {
+        case IBMPC_ERR_PARITY:    f->errors[0]++; break;
+        case IBMPC_ERR_PARITY_AA: f->errors[1]++; break;
+        case IBMPC_ERR_TIMEOUT:   f->errors[2]++; break;
+        case IBMPC_ERR_FULL:      f->errors[3]++; break;
+        case IBMPC_ERR_ILLEGAL:   f->errors[4]++; break;
+    }
+
+    int b = length / bucket_us;
+    if (b > LENGTH_BUCKETS) b = LENGTH_BUCKETS;
+    if (error && error != IBMPC_ERR_FULL) {
+        f->length_err[b]++;
+    } else {
+        f->length_ok[b]++;
+        if (length > f->length_max_ok) f->length_max_ok = length;
+    }
+
+    double gap = -1;
+    if (f->has_last && !lost) {
+        gap = start - f->last_end;
+        int g = 0;
+        while (g < GAP_BUCKETS && gap >= (double)(1UL << (GAP_MIN_LOG2 + g))) g++;
+        f->gap[g]++;
+        if (f->gap_min < 0 || gap < f->gap_min) f->gap_min = gap;
+    }
+    f->last_end = end;
+    f->has_last = 1;
+
+    if (verbose) {
+        printf("%u: %12.0f len:%6.0f gap:", clock_bit, start, length);
+        if (gap < 0) printf("%9s", "-"); else printf("%9.0f", gap);
+        printf(" ISR:%04X %-8s", state, protocol_str(protocol));
+        if (error) printf(" ERR:%02X %s", error, error_str(error));
+        else printf(" %02X", data);
+        if (lost) printf(" lost:%u", lost);
+        putchar('\n');
+    }
+}
+
+static void decode(FILE *in)
+{
+    int c;
+    while ((c = getc(in)) != EOF) {
+        if (c != IBMPC_CAPTURE_FRAME_START) {
+            if (passthrough) putchar(c);
+            continue;
+        }
+
+        int len = getc(in);
+        if (len == EOF) break;
+        uint8_t frame[256], rec[256];
+        if (fread(frame, 1, len, in) != (size_t)len) break;
+        if (cobs_decode(frame, len, rec) != RECORD_SIZE) {
+            broken++;
+            continue;
+        }
+        record(rec);
+    }
+}
+
+
+static void bar(unsigned long n, unsigned long max)
+{
+    int w = max ? (n * 40 + max - 1) / max : 0;
+    while (w--) putchar('#');
+    putchar('\n');
+}
+
+static void report(int clock_bit, interface_t *f)
+{
+    printf("\ninterface: clock bit %d  frames: %lu  lost: %lu\n", clock_bit, f->frames, f->lost);
+    printf("protocol: AT %lu  AT_Z150 %lu  XT_IBM %lu  XT_CLONE %lu\n",
+            f->protocols[0], f->protocols[1], f->protocols[2], f->protocols[3]);
+    printf("error: PARITY %lu  PARITY_AA %lu  TIMEOUT %lu  FULL %lu  ILLEGAL %lu\n",
+            f->errors[0], f->errors[1], f->errors[2], f->errors[3], f->errors[4]);
+
+    printf("length(us)          ok      err   longest ok: %.0f\n", f->length_max_ok);
+    unsigned long max = 0;
+    int first = -1, last = -1;
+    for (int b = 0; b <= LENGTH_BUCKETS; b++) {
+        unsigned long n = f->length_ok[b] + f->length_err[b];
+        if (n > max) max = n;
+        if (n && first < 0) first = b;
+        if (n) last = b;
+    }
+    for (int b = (first < 0 ? 0 : first); b <= last; b++) {
+        unsigned long n = f->length_ok[b] + f->length_err[b];
+        if (b < LENGTH_BUCKETS) {
+            printf("%6u-%-7u", b * bucket_us, (b + 1) * bucket_us);
+        } else {
+            printf("%6u-       ", b * bucket_us);
+        }
+        printf(" %8lu %8lu  ", f->length_ok[b], f->length_err[b]);
+        bar(n, max);
+    }
+
+    printf("gap(us)          frames   shortest: %.0f\n", f->gap_min < 0 ? 0 : f->gap_min);
+    max = 0;
+    first = -1;
+    last = -1;
+    for (int g = 0; g <= GAP_BUCKETS; g++) {
+        if (f->gap[g] > max) max = f->gap[g];
+        if (f->gap[g] && first < 0) first = g;
+        if (f->gap[g]) last = g;
+    }
+    for (int g = (first < 0 ? 0 : first); g <= last; g++) {
+        if (g == 0) {
+            printf("%8s-%-8lu", "0", 1UL << GAP_MIN_LOG2);
+        } else if (g < GAP_BUCKETS) {
+            printf("%8lu-%-8lu", 1UL << (GAP_MIN_LOG2 + g - 1), 1UL << (GAP_MIN_LOG2 + g));
+        } else {
+            printf("%8lu-%-8s", 1UL << (GAP_MIN_LOG2 + g - 1), "");
+        }
+        printf(" %8lu  ", f->gap[g]);
+        bar(f->gap[g], max);
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "vpw:")) != -1) {
+        switch (opt) {
+            case 'v': verbose = 1; break;
+            case 'p': passthrough = 1; break;
+            case 'w': bucket_us = atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-v] [-p] [-w us] [log]\n", argv[0]);
+                return 2;
+        }
+    }
+    if (bucket_us == 0) bucket_us = 250;
+
+    FILE *in = stdin;
+    if (optind < argc && !(in = fopen(argv[optind], "rb"))) {
+        perror(argv[optind]);
+        return 1;
+    }
+    for (int i = 0; i < INTERFACES; i++) ifs[i].gap_min = -1;
+    decode(in);
+
+    for (int i = 0; i < INTERFACES; i++) {
+        if (ifs[i].seen) report(i, &ifs[i]);
+    }
+    if (broken) printf("\nbroken records: %lu\n", broken);
+    return 0;
+}
@@ -0,0 +1,642 @@
+/*
+ * Generator of scan code tables for protocol/ibmpc_codeset.h
+ *
+ *      ibmpc_codeset codeset.txt > codeset.h
+ *      ibmpc_codeset -c corpus.txt [-c corpus.txt...] codeset.txt
+ *
+ * Reads description of code sets, see converter/ibmpc_usb/codeset.txt for
+ * its format, and prints tables for PROGMEM. Each state takes the most
+ * common entries of codes 00-7F and 80-FF as its defaults and the rest are
+ * packed into exception table at first base where they fit. States with
+ * same entries share one row.
+ *
+ * -c decodes byte streams of corpus file with the tables and compares
+ * events with expected ones, exits with 1 on mismatch. One stream per line,
+ * codes and expected events separated with ':'. State goes on to next line.
+ *
+ *      # select code set and keyboard ID, ID can be omitted
+ *      set 2 AB83
+ *      E0 12 E0 7C         : +7F
+ *      E0 F0 7C E0 F0 12   : -7F
+ *
+ * Events are +XX for make, -XX for break, suffixed with '!' when code is
+ * unknown, and overrun, error, reset, unknown and clear.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include "ibmpc_codeset.h"
+
+
+#define MAX_STATES      64
+#define MAX_LINES       2048
+#define MAX_VARIANTS    16
+#define MAX_IDS         8
+
+// action of line
+enum { A_KEY, A_SAME, A_WARN, A_GOTO, A_EVENT };
+
+typedef struct {
+    int lineno;
+    int set;            // index of sets
+    int variant;        // -1 for base
+    int state;          // -1 for all
+    bool dflt;          // codes is *
+    uint8_t codes[256];
+    int action;
+    int arg;
+    char name[32];      // of goto
+} line_t;
+
+typedef struct {
+    char name[32];
+    int event;
+    int from;           // -1 for none
+    char from_name[32];
+    int lineno;
+} state_t;
+
+typedef struct {
+    int n;
+    uint16_t ids[MAX_IDS];
+} variant_t;
+
+typedef struct {
+    int number;
+    int n_states;
+    state_t states[MAX_STATES];
+    int n_variants;
+    variant_t variants[MAX_VARIANTS];
+} set_t;
+
+static set_t sets[4];
+static int n_sets = 0;
+static line_t lines[MAX_LINES];
+static int n_lines = 0;
+static const char *path;
+
+// output tables
+static ibmpc_cs_state_t out_states[256];
+static char out_names[256][48];
+static int n_out_states = 0;
+static uint8_t out_entries[16384];
+static uint8_t out_rows[16384];
+static bool used[16384];
+static int n_out_entries = 0;
+static uint8_t row_entries[256][256];
+static uint8_t row_dflt[256][2];
+static int n_rows = 0;
+static int n_exceptions = 0;
+static ibmpc_cs_variant_t out_variants[64];
+static int n_out_variants = 0;
+
+
+static void die(int lineno, const char *msg, const char *arg)
+{
+    fprintf(stderr, "%s:%d: %s%s%s\n", path, lineno, msg, arg ? ": " : "", arg ? arg : "");
+    exit(2);
+}
+
+static int find_state(set_t *s, const char *name)
+{
+    for (int i = 0; i < s->n_states; i++) {
+        if (!strcmp(s->states[i].name, name)) return i;
+    }
+    return -1;
+}
+
+static bool parse_hex(const char *p, char **end, unsigned *v)
+{
+    if (!isxdigit((unsigned char)*p)) return false;
+    *v = strtoul(p, end, 16);
+    return *v <= 0xFF;
+}
+
+static void parse_codes(line_t *l, char *tok)
+{
+    if (!strcmp(tok, "*")) {
+        l->dflt = true;
+        return;
+    }
+    char *p = tok;
+    while (*p) {
+        unsigned lo, hi;
+        char *end;
+        if (!parse_hex(p, &end, &lo)) die(l->lineno, "bad code", tok);
+        hi = lo;
+        if (*end == '-') {
+            if (!parse_hex(end + 1, &end, &hi) || hi < lo) die(l->lineno, "bad range", tok);
+        }
+        for (unsigned c = lo; c <= hi; c++) l->codes[c] = 1;
+        if (*end == ',') end++;
+        else if (*end) die(l->lineno, "bad code", tok);
+        p = end;
+    }
+}
+
+static void parse_action(line_t *l, char *tok, char *arg)
+{
+    static const struct { const char *name; int event; } events[] = {
+        { "ignore",  IBMPC_CS_NONE },
+        { "overrun", IBMPC_CS_OVERRUN },
+        { "error",   IBMPC_CS_ERROR },
+        { "reset",   IBMPC_CS_RESET },
+        { "unknown", IBMPC_CS_UNKNOWN },
+        { "clear",   IBMPC_CS_CLEAR },
+    };
+
+    if (!tok) die(l->lineno, "no action", NULL);
+    if (!strcmp(tok, "=")) {
+        l->action = A_SAME;
+    } else if (!strcmp(tok, "warn")) {
+        l->action = A_WARN;
+    } else if (!strcmp(tok, "->")) {
+        if (!arg) die(l->lineno, "no state", NULL);
+        l->action = A_GOTO;
+        snprintf(l->name, sizeof(l->name), "%s", arg);
+    } else {
+        for (unsigned i = 0; i < sizeof(events)/sizeof(events[0]); i++) {
+            if (!strcmp(tok, events[i].name)) {
+                l->action = A_EVENT;
+                l->arg = events[i].event;
+                return;
+            }
+        }
+        unsigned v;
+        char *end;
+        if (!parse_hex(tok, &end, &v) || *end || v > 0x7F) die(l->lineno, "bad action", tok);
+        l->action = A_KEY;
+        l->arg = v;
+    }
+}
+
+static void parse(FILE *in)
+{
+    char buf[256];
+    int lineno = 0;
+    set_t *s = NULL;
+    int variant = -1;
+    int state = -2;     // -1: all, -2: none
+
+    while (fgets(buf, sizeof(buf), in)) {
+        lineno++;
+        char *p = strchr(buf, '#');
+        if (p) *p = '\0';
+
+        char *tok[6] = { 0 };
+        int n = 0;
+        for (char *t = strtok(buf, " \t\r\n"); t && n < 6; t = strtok(NULL, " \t\r\n")) tok[n++] = t;
+        if (!n) continue;
+
+        if (!strcmp(tok[0], "set")) {
+            if (n < 2) die(lineno, "no code set", NULL);
+            int number = atoi(tok[1]);
+            s = NULL;
+            for (int i = 0; i < n_sets; i++) {
+                if (sets[i].number == number) s = &sets[i];
+            }
+            if (n == 2) {
+                if (s) die(lineno, "code set defined twice", tok[1]);
+                if (n_sets == 4) die(lineno, "too many code sets", NULL);
+                s = &sets[n_sets++];
+                s->number = number;
+                variant = -1;
+            } else {
+                if (!s) die(lineno, "variant of undefined code set", tok[1]);
+                if (s->n_variants == MAX_VARIANTS) die(lineno, "too many variants", NULL);
+                variant_t *v = &s->variants[s->n_variants];
+                for (char *id = strtok(tok[2], ","); id; id = strtok(NULL, ",")) {
+                    if (v->n == MAX_IDS) die(lineno, "too many IDs", NULL);
+                    v->ids[v->n++] = strtoul(id, NULL, 16);
+                }
+                variant = s->n_variants++;
+            }
+            state = -2;
+        } else if (!strcmp(tok[0], "all")) {
+            if (!s) die(lineno, "no code set", NULL);
+            state = -1;
+        } else if (!strcmp(tok[0], "state")) {
+            if (!s) die(lineno, "no code set", NULL);
+            if (n < 2) die(lineno, "no state name", NULL);
+            state = find_state(s, tok[1]);
+            if (variant >= 0) {
+                if (state < 0) die(lineno, "state not in code set", tok[1]);
+                if (n > 2) die(lineno, "variant can't change state", tok[1]);
+                continue;
+            }
+            if (state >= 0) die(lineno, "state defined twice", tok[1]);
+            if (s->n_states == MAX_STATES) die(lineno, "too many states", NULL);
+            state = s->n_states++;
+            state_t *st = &s->states[state];
+            snprintf(st->name, sizeof(st->name), "%s", tok[1]);
+            st->event = IBMPC_CS_MAKE;
+            st->from = -1;
+            st->lineno = lineno;
+            for (int i = 2; i < n; i++) {
+                if (!strcmp(tok[i], "make")) {
+                    st->event = IBMPC_CS_MAKE;
+                } else if (!strcmp(tok[i], "break")) {
+                    st->event = IBMPC_CS_BREAK;
+                } else if (!strcmp(tok[i], "bit7")) {
+                    st->event = IBMPC_CS_BIT7;
+                } else if (!strcmp(tok[i], "from") && i + 1 < n) {
+                    snprintf(st->from_name, sizeof(st->from_name), "%s", tok[++i]);
+                } else {
+                    die(lineno, "bad state option", tok[i]);
+                }
+            }
+        } else {
+            if (state == -2) die(lineno, "no state", NULL);
+            if (n_lines == MAX_LINES) die(lineno, "too many lines", NULL);
+            line_t *l = &lines[n_lines++];
+            memset(l, 0, sizeof(*l));
+            l->lineno = lineno;
+            l->set = s - sets;
+            l->variant = variant;
+            l->state = state;
+            parse_codes(l, tok[0]);
+            parse_action(l, tok[1], tok[2]);
+        }
+    }
+
+    for (int i = 0; i < n_sets; i++) {
+        set_t *s = &sets[i];
+        if (!s->n_states) die(0, "code set has no state", NULL);
+        if (s->n_states > 0x40) die(s->states[0].lineno, "too many states", NULL);
+        for (int j = 0; j < s->n_states; j++) {
+            state_t *st = &s->states[j];
+            if (!st->from_name[0]) continue;
+            st->from = find_state(s, st->from_name);
+            if (st->from < 0) die(st->lineno, "unknown state", st->from_name);
+        }
+    }
+    for (int i = 0; i < n_lines; i++) {
+        line_t *l = &lines[i];
+        if (l->action != A_GOTO) continue;
+        l->arg = find_state(&sets[l->set], l->name);
+        if (l->arg < 0) die(l->lineno, "unknown state", l->name);
+    }
+}
+
+
+static uint8_t entry_of(const line_t *l, uint8_t code)
+{
+    switch (l->action) {
+    case A_KEY:     return (l->arg == (code & 0x7F)) ? IBMPC_CS_SAME : l->arg;
+    case A_SAME:    return IBMPC_CS_SAME;
+    case A_WARN:    return IBMPC_CS_DO | IBMPC_CS_WARN;
+    case A_GOTO:    return IBMPC_CS_GOTO | l->arg;
+    default:        return IBMPC_CS_DO | l->arg;
+    }
+}
+
+static void apply(const line_t *l, const state_t *st, uint8_t *e, bool *given)
+{
+    for (int c = 0; c < 256; c++) {
+        // code 00-7F of bit7 state stands for its break code as well
+        bool hit = l->dflt ? !given[c] :
+                   (l->codes[c] || (st->event == IBMPC_CS_BIT7 && c >= 0x80 && l->codes[c & 0x7F]));
+        if (hit) e[c] = entry_of(l, c);
+    }
+    if (!l->dflt) {
+        for (int c = 0; c < 256; c++) {
+            if (l->codes[c]) given[c] = true;
+            if (st->event == IBMPC_CS_BIT7 && c < 0x80 && l->codes[c]) given[c | 0x80] = true;
+        }
+    }
+}
+
+// lines of base and variant on top of state 'from', without lines of all
+static void resolve(int set, int variant, int state, uint8_t *e, bool *given, int depth)
+{
+    const state_t *st = &sets[set].states[state];
+    if (depth > MAX_STATES) die(st->lineno, "loop of from", st->name);
+
+    if (st->from >= 0) {
+        resolve(set, variant, st->from, e, given, depth + 1);
+    } else {
+        for (int c = 0; c < 256; c++) {
+            e[c] = IBMPC_CS_DO | IBMPC_CS_NONE;
+            given[c] = false;
+        }
+    }
+
+    // given codes first, then * for the rest
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < n_lines; i++) {
+            const line_t *l = &lines[i];
+            if (l->set != set || l->state != state || l->dflt != (pass == 1)) continue;
+            if (l->variant != -1 && l->variant != variant) continue;
+            apply(l, st, e, given);
+        }
+    }
+}
+
+static void build_state(int set, int variant, int state)
+{
+    const state_t *st = &sets[set].states[state];
+    uint8_t e[256];
+    bool given[256];
+    resolve(set, variant, state, e, given, 0);
+    for (int i = 0; i < n_lines; i++) {
+        const line_t *l = &lines[i];
+        if (l->set != set || l->state != -1) continue;
+        if (l->variant != -1 && l->variant != variant) continue;
+        bool none[256] = { false };
+        apply(l, st, e, none);
+    }
+
+    // defaults of 00-7F and 80-FF
+    uint8_t dflt[2];
+    for (int h = 0; h < 2; h++) {
+        int count[256] = { 0 };
+        dflt[h] = e[h * 0x80];
+        for (int c = h * 0x80; c < h * 0x80 + 0x80; c++) {
+            if (++count[e[c]] > count[dflt[h]]) dflt[h] = e[c];
+        }
+    }
+
+    // share row of same entries
+    int row;
+    for (row = 0; row < n_rows; row++) {
+        if (!memcmp(row_entries[row], e, 256)) break;
+    }
+    if (row == n_rows) {
+        // 0xFF is row of empty entry
+        if (n_rows == 0xFF) die(st->lineno, "too many rows", NULL);
+        memcpy(row_entries[n_rows], e, 256);
+        row_dflt[n_rows][0] = dflt[0];
+        row_dflt[n_rows][1] = dflt[1];
+        n_rows++;
+    }
+
+    if (n_out_states == 256) die(st->lineno, "too many states", NULL);
+    ibmpc_cs_state_t *o = &out_states[n_out_states];
+    o->dflt_lo = dflt[0];
+    o->dflt_hi = dflt[1];
+    o->event = st->event;
+    o->row = row;
+    snprintf(out_names[n_out_states], sizeof(out_names[0]), "%u %s", sets[set].number, st->name);
+    n_out_states++;
+}
+
+static int exceptions(int row)
+{
+    int n = 0;
+    for (int c = 0; c < 256; c++) {
+        if (row_entries[row][c] != row_dflt[row][c >> 7]) n++;
+    }
+    return n;
+}
+
+// rows with more exceptions first at lowest base where they fit, base can be
+// negative as position of code wraps around in 16-bit
+static void place_rows(void)
+{
+    int order[256];
+    for (int i = 0; i < n_rows; i++) order[i] = i;
+    for (int i = 1; i < n_rows; i++) {
+        for (int j = i; j > 0 && exceptions(order[j]) > exceptions(order[j - 1]); j--) {
+            int t = order[j]; order[j] = order[j - 1]; order[j - 1] = t;
+        }
+    }
+
+    int base[256];
+    for (int i = 0; i < n_rows; i++) {
+        int row = order[i];
+        const uint8_t *e = row_entries[row];
+        int b;
+        for (b = -255; ; b++) {
+            if (b + 256 > (int)sizeof(out_entries)) die(0, "too many entries", NULL);
+            int c;
+            for (c = 0; c < 256; c++) {
+                if (e[c] != row_dflt[row][c >> 7] && (b + c < 0 || used[b + c])) break;
+            }
+            if (c == 256) break;
+        }
+        for (int c = 0; c < 256; c++) {
+            if (e[c] == row_dflt[row][c >> 7]) continue;
+            used[b + c] = true;
+            out_entries[b + c] = e[c];
+            out_rows[b + c] = row;
+            if (b + c + 1 > n_out_entries) n_out_entries = b + c + 1;
+            n_exceptions++;
+        }
+        base[row] = b;
+    }
+    for (int i = 0; i < n_out_states; i++) {
+        out_states[i].base = (uint16_t)base[out_states[i].row];
+    }
+}
+
+// variants with IDs come first to be found before base of code set
+static void build(void)
+{
+    memset(out_rows, 0xFF, sizeof(out_rows));
+    for (int i = 0; i < n_sets; i++) {
+        set_t *s = &sets[i];
+        for (int v = s->n_variants - 1; v >= -1; v--) {
+            int base = n_out_states;
+            if (base + s->n_states > 0xFF) die(s->states[0].lineno, "too many states", NULL);
+            for (int j = 0; j < s->n_states; j++) build_state(i, v, j);
+
+            if (v < 0) {
+                out_variants[n_out_variants++] = (ibmpc_cs_variant_t){ s->number, true, 0, base };
+                continue;
+            }
+            for (int k = 0; k < s->variants[v].n; k++) {
+                if (n_out_variants == 64) die(0, "too many variants", NULL);
+                out_variants[n_out_variants++] =
+                    (ibmpc_cs_variant_t){ s->number, false, s->variants[v].ids[k], base };
+            }
+        }
+    }
+    place_rows();
+}
+static void print_tables(const char *name)
+{
+    static const char *event[] = { "", "IBMPC_CS_MAKE", "IBMPC_CS_BREAK", "IBMPC_CS_BIT7" };
+
+    printf("/* Generated from %s by tool/host/ibmpc_codeset.c, don't edit. */\n", name);
+    printf("#ifndef CODESET_H\n#define CODESET_H\n\n#include \"ibmpc_codeset.h\"\n\n");
+    printf("// states: %d(%d bytes)  rows: %d  exceptions: %d in %d entries(%d bytes)\n\n",
+           n_out_states, n_out_states * 6, n_rows, n_exceptions, n_out_entries, n_out_entries * 2);
+
+    printf("static const ibmpc_cs_variant_t ibmpc_cs_variants[] PROGMEM = {\n");
+    for (int i = 0; i < n_out_variants; i++) {
+        ibmpc_cs_variant_t *v = &out_variants[i];
+        printf("    { %u, %-5s, 0x%04X, %3u },\n", v->set, v->any ? "true" : "false", v->id, v->base);
+    }
+    printf("};\n#define IBMPC_CS_VARIANTS   %d\n\n", n_out_variants);
+
+    printf("static const ibmpc_cs_state_t ibmpc_cs_states[] PROGMEM = {\n");
+    printf("    // lo,  hi,   event,          row,  base\n");
+    for (int i = 0; i < n_out_states; i++) {
+        ibmpc_cs_state_t *s = &out_states[i];
+        char ev[24];
+        snprintf(ev, sizeof(ev), "%s,", event[s->event]);
+        printf("    { 0x%02X, 0x%02X, %-15s %3u, %5u },  // %3d: %s\n",
+               s->dflt_lo, s->dflt_hi, ev, s->row, s->base, i, out_names[i]);
+    }
+    printf("};\n\n");
+
+    printf("#define IBMPC_CS_ENTRIES    %d\n", n_out_entries);
+    printf("static const uint8_t ibmpc_cs_entries[] PROGMEM = {");
+    for (int i = 0; i < n_out_entries; i++) {
+        if (i % 16 == 0) printf("\n    /* %4d */", i);
+        printf(" 0x%02X,", out_entries[i]);
+    }
+    printf("\n};\n\n");
+
+    printf("static const uint8_t ibmpc_cs_rows[] PROGMEM = {");
+    for (int i = 0; i < n_out_entries; i++) {
+        if (i % 16 == 0) printf("\n    /* %4d */", i);
+        printf(" 0x%02X,", out_rows[i]);
+    }
+    printf("\n};\n\n#endif\n");
+}
+
+
+static int check_line(const char *file, int lineno, char *buf, uint8_t base, uint8_t *state)
+{
+    static const char *event[] = { "", "", "", "", "overrun", "error", "reset", "unknown", "clear" };
+
+    char *colon = strchr(buf, ':');
+    if (!colon) {
+        fprintf(stderr, "%s:%d: no ':'\n", file, lineno);
+        exit(2);
+    }
+    *colon = '\0';
+
+    char got[512] = "";
+    char *p = buf;
+    while (*p) {
+        while (isspace((unsigned char)*p)) p++;
+        if (!*p) break;
+        unsigned code;
+        char *end;
+        if (!parse_hex(p, &end, &code)) {
+            fprintf(stderr, "%s:%d: bad code: %s\n", file, lineno, p);
+            exit(2);
+        }
+        p = end;
+
+        uint8_t key = 0;
+        uint8_t ev = ibmpc_cs_step(&out_states[base], out_entries, out_rows, n_out_entries,
+                                   state, code, &key);
+        uint8_t e = ev & ~IBMPC_CS_WARN;
+        char tok[16] = "";
+        if (e == IBMPC_CS_MAKE || e == IBMPC_CS_BREAK) {
+            snprintf(tok, sizeof(tok), "%c%02X%s", e == IBMPC_CS_MAKE ? '+' : '-', key,
+                     (ev & IBMPC_CS_WARN) ? "!" : "");
+        } else if (e != IBMPC_CS_NONE) {
+            snprintf(tok, sizeof(tok), "%s", event[e]);
+        }
+        if (tok[0]) {
+            if (got[0]) strcat(got, " ");
+            strcat(got, tok);
+        }
+    }
+
+    // compare with expected events ignoring spaces between them
+    char want[512] = "";
+    for (char *t = strtok(colon + 1, " \t\r\n"); t; t = strtok(NULL, " \t\r\n")) {
+        if (want[0]) strcat(want, " ");
+        strcat(want, t);
+    }
+    if (strcmp(got, want)) {
+        printf("%s:%d: expected '%s' but '%s'\n", file, lineno, want, got);
+        return 1;
+    }
+    return 0;
+}
+
+static int check(const char *file)
+{
+    FILE *in = fopen(file, "r");
+    if (!in) {
+        perror(file);
+        exit(2);
+    }
+
+    char buf[512];
+    int lineno = 0, streams = 0, mismatch = 0;
+    uint8_t base = 0xFF, state = 0;
+    while (fgets(buf, sizeof(buf), in)) {
+        lineno++;
+        char *p = strchr(buf, '#');
+        if (p) *p = '\0';
+        for (p = buf; isspace((unsigned char)*p); p++) ;
+        if (!*p) continue;
+
+        if (!strncmp(p, "set", 3)) {
+            unsigned set = 0, id = 0xFFFF;
+            if (sscanf(p + 3, "%u %x", &set, &id) < 1) {
+                fprintf(stderr, "%s:%d: bad set\n", file, lineno);
+                exit(2);
+            }
+            base = ibmpc_cs_select(out_variants, n_out_variants, set, id);
+            if (base == 0xFF) {
+                fprintf(stderr, "%s:%d: no code set %u\n", file, lineno, set);
+                exit(2);
+            }
+            state = 0;
+            continue;
+        }
+        if (base == 0xFF) {
+            fprintf(stderr, "%s:%d: no set\n", file, lineno);
+            exit(2);
+        }
+        mismatch += check_line(file, lineno, p, base, &state);
+        streams++;
+    }
+    fclose(in);
+    printf("corpus: %s  streams: %d  mismatch: %d\n", file, streams, mismatch);
+    return mismatch;
+}
+
+
+int main(int argc, char *argv[])
+{
+    const char *corpus[16];
+    int n_corpus = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "c:")) != -1) {
+        switch (opt) {
+            case 'c':
+                if (n_corpus < 16) corpus[n_corpus++] = optarg;
+                break;
+            default:
+                goto usage;
+        }
+    }
+    if (optind != argc - 1) goto usage;
+
+    path = argv[optind];
+    FILE *in = fopen(path, "r");
+    if (!in) {
+        perror(path);
+        return 2;
+    }
+    parse(in);
+    fclose(in);
+    build();
+
+    if (!n_corpus) {
+        const char *name = strrchr(path, '/');
+        print_tables(name ? name + 1 : path);
+        return 0;
+    }
+
+    int mismatch = 0;
+    for (int i = 0; i < n_corpus; i++) mismatch += check(corpus[i]);
+    return mismatch ? 1 : 0;
+
+usage:
+    fprintf(stderr, "usage: %s [-c corpus]... codeset.txt\n", argv[0]);
+    return 2;
+}
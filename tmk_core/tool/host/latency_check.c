@@ -0,0 +1,199 @@
+/*
+ * Check of latency trace math(common/latency_trace.c)
+ *
+ *      latency_check
+ *
+ * Feeds known deltas through latency_trace_start/mark/end() with fake clock
+ * and checks min, avg, max, histogram buckets and percentiles of stats,
+ * stages deferred to report queue and conversion of ticks to microseconds. Built with TICKS_PER_MS of AVR at
+ * 16MHz(251) so one tick of fake clock stands for one Timer0 count.
+ *
+ * Exit status is 1 on any mismatch.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include "timer.h"
+#include "latency_trace.h"
+
+
+static int failed = 0;
+
+#define CHECK(expr, expected) do { \
+    uint32_t v = (expr); \
+    if (v != (uint32_t)(expected)) { \
+        printf("NG: %s = %u, expected %u\n", #expr, v, (uint32_t)(expected)); \
+        failed++; \
+    } \
+} while (0)
+
+
+/* one key event whose stage is reached delta ticks after scan */
+static void feed(uint8_t stage, uint32_t delta)
+{
+    timer_host_set(1000);
+    latency_trace_scan();
+    latency_trace_start();
+    timer_host_advance_us(delta);
+    latency_trace_mark(stage);
+    latency_trace_end();
+}
+
+static void check_stats(void)
+{
+    latency_trace_clear();
+    /* 98 fast events and two slow ones */
+    for (int i = 0; i < 98; i++) feed(LATENCY_TRACE_ENDPOINT, 5);
+    feed(LATENCY_TRACE_ENDPOINT, 300);
+    feed(LATENCY_TRACE_ENDPOINT, 1000);
+
+    const latency_stat_t *s = latency_trace_stat(LATENCY_TRACE_ENDPOINT);
+    CHECK(s->count, 100);
+    CHECK(s->min, 5);
+    CHECK(s->max, 1000);
+    CHECK(s->sum, 98 * 5 + 300 + 1000);
+    CHECK(s->sum / s->count, 17);
+    CHECK(s->hist[2], 98);      // [4, 8)
+    CHECK(s->hist[8], 1);       // [256, 512)
+    CHECK(s->hist[9], 1);       // [512, 1024)
+
+    /* upper bound of bucket, not over max */
+    CHECK(latency_trace_percentile(s, 50), 7);
+    CHECK(latency_trace_percentile(s, 98), 7);
+    CHECK(latency_trace_percentile(s, 99), 511);
+    CHECK(latency_trace_percentile(s, 100), 1000);
+
+    /* scan stage is marked at start with zero delta */
+    const latency_stat_t *scan = latency_trace_stat(LATENCY_TRACE_MATRIX_SCAN);
+    CHECK(scan->count, 100);
+    CHECK(scan->max, 0);
+    CHECK(scan->hist[0], 100);
+
+    /* stages not reached are left out */
+    CHECK(latency_trace_stat(LATENCY_TRACE_TAPPING)->count, 0);
+    CHECK(latency_trace_percentile(latency_trace_stat(LATENCY_TRACE_TAPPING), 99), 0);
+}
+
+static void check_buckets(void)
+{
+    static const struct { uint32_t delta; uint8_t bucket; } cases[] = {
+        { 1, 0 }, { 2, 1 }, { 3, 1 }, { 4, 2 }, { 255, 7 }, { 256, 8 },
+        { 32767, 14 }, { 32768, 15 }, { 65534, 15 },
+        { 100000, 15 },     // saturated to 65534
+    };
+    for (unsigned i = 0; i < sizeof(cases)/sizeof(cases[0]); i++) {
+        latency_trace_clear();
+        feed(LATENCY_TRACE_HOST_SEND, cases[i].delta);
+        const latency_stat_t *s = latency_trace_stat(LATENCY_TRACE_HOST_SEND);
+        CHECK(s->hist[cases[i].bucket], 1);
+        CHECK(s->max, cases[i].delta < 0xFFFF ? cases[i].delta : 0xFFFE);
+    }
+}
+
+static void check_mark_once(void)
+{
+    /* first mark of stage counts, e.g. second report of the same event */
+    latency_trace_clear();
+    timer_host_set(2000);
+    latency_trace_scan();
+    timer_host_advance_us(10);
+    latency_trace_start();
+    timer_host_advance_us(20);
+    latency_trace_mark(LATENCY_TRACE_ADD_KEY);
+    timer_host_advance_us(20);
+    latency_trace_mark(LATENCY_TRACE_ADD_KEY);
+    latency_trace_end();
+    /* mark after end is ignored */
+    latency_trace_mark(LATENCY_TRACE_ADD_KEY);
+
+    const latency_stat_t *s = latency_trace_stat(LATENCY_TRACE_ADD_KEY);
+    CHECK(s->count, 1);
+    CHECK(s->max, 30);      // from scan, not from start
+}
+
+static void check_defer(void)
+{
+    latency_trace_clear();
+
+    /* written to endpoint before record is closed */
+    timer_host_set(3000);
+    latency_trace_scan();
+    latency_trace_start();
+    uint8_t tag = latency_trace_defer(LATENCY_TRACE_ENDPOINT);
+    CHECK(tag != 0, 1);
+    /* stage marked directly is ignored while deferred */
+    timer_host_advance_us(5);
+    latency_trace_mark(LATENCY_TRACE_ENDPOINT);
+    timer_host_advance_us(5);
+    latency_trace_done(tag);
+    latency_trace_end();
+    const latency_stat_t *s = latency_trace_stat(LATENCY_TRACE_ENDPOINT);
+    CHECK(s->count, 1);
+    CHECK(s->max, 10);
+
+    /* written after two more events are closed */
+    timer_host_set(4000);
+    latency_trace_scan();
+    latency_trace_start();
+    tag = latency_trace_defer(LATENCY_TRACE_ENDPOINT);
+    latency_trace_end();
+    feed(LATENCY_TRACE_ENDPOINT, 7);
+    feed(LATENCY_TRACE_ENDPOINT, 7);
+    CHECK(s->count, 3);
+    timer_host_set(4000);
+    timer_host_advance_us(400);
+    latency_trace_done(tag);
+    CHECK(s->count, 4);
+    CHECK(s->max, 400);
+    /* tag is given back only once */
+    latency_trace_done(tag);
+    CHECK(s->count, 4);
+
+    /* discarded report is not counted and frees its slot */
+    latency_trace_start();
+    tag = latency_trace_defer(LATENCY_TRACE_ENDPOINT);
+    latency_trace_cancel(tag);
+    latency_trace_end();
+    CHECK(s->count, 4);
+    for (uint8_t i = 0; i < LATENCY_TRACE_PENDING; i++) {
+        latency_trace_start();
+        CHECK(latency_trace_defer(LATENCY_TRACE_ENDPOINT) != 0, 1);
+        latency_trace_end();
+    }
+    /* all slots are in use */
+    latency_trace_start();
+    CHECK(latency_trace_defer(LATENCY_TRACE_ENDPOINT), 0);
+    latency_trace_end();
+
+    /* tag held over clear is counted in new stats, not in current record */
+    latency_trace_clear();
+    latency_trace_start();
+    latency_trace_done(1);
+    CHECK(latency_trace_stat(LATENCY_TRACE_ENDPOINT)->count, 1);
+    latency_trace_mark(LATENCY_TRACE_ENDPOINT);
+    latency_trace_end();
+    CHECK(latency_trace_stat(LATENCY_TRACE_ENDPOINT)->count, 2);
+    for (uint8_t i = 2; i <= LATENCY_TRACE_PENDING; i++) latency_trace_cancel(i);
+}
+
+static void check_ticks_to_us(void)
+{
+    /* Timer0 counts 0..250 in a millisecond */
+    CHECK(latency_trace_ticks_to_us(0), 0);
+    CHECK(latency_trace_ticks_to_us(1), 3);
+    CHECK(latency_trace_ticks_to_us(251), 1000);
+    CHECK(latency_trace_ticks_to_us(2510), 10000);
+    CHECK(latency_trace_ticks_to_us(65535), 261095);
+}
+
+
+int main(void)
+{
+    check_stats();
+    check_buckets();
+    check_mark_once();
+    check_defer();
+    check_ticks_to_us();
+
+    printf("latency: %s\n", failed ? "NG" : "OK");
+    return failed ? 1 : 0;
+}
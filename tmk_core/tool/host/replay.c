@@ -0,0 +1,980 @@
+/*
+ * Key event replay for host build
+ *
+ * Feeds recorded key events into tmk_core through a virtual matrix and
+ * prints every report the core sends to its host driver. Time is fake and
+ * advanced 1ms per keyboard_task() so that output is deterministic and can
+ * be compared against a known good sequence.
+ *
+ * Usage: replay [-v] [-e expected] [-b count] [-t tail_ms] [-w us] [-p ms] [-c ms] [-l hex] [-r keys] [-m steps] [-d] [-o bytes] trace
+ *        replay -k layers
+ *        replay -K
+ *
+ *  -v          debug print of tmk_core to stderr(needs CONSOLE_ENABLE)
+ *  -e file     compare output with file, exit status 1 on mismatch
+ *  -b count    benchmark: feed trace count times into action_exec() directly
+ *  -t ms       time to run after last event to settle tapping(default 1000)
+ *  -w us       time spent by driver for each keyboard report(default 0),
+ *              driver waits for endpoint and tells no pending report like
+ *              drivers without queue
+ *  -p ms       interval host polls keyboard endpoint(default 1), reports
+ *              wait in driver until taken and are seen by macro player
+ *  -c ms       add chatter of this time to every key event and debounce it
+ *              with matrix_debounce(), exit status 1 if chatter leaks
+ *  -l hex      layer state to start with, e.g. FFFF to stack 16 layers
+ *  -r keys     rolling keys instead of trace file: each key is pressed while
+ *              this number of previous keys are still held
+ *  -m steps    play macro of this number of steps from start and check
+ *              that matrix is scanned every 1ms meanwhile and no more than
+ *              one report waits in driver, exit status 1 if not
+ *  -d          print delay of key events from scan to action, e.g. held by
+ *              tapping until tap or hold is decided
+ *  -o bytes    console output to stderr through buffer of this size which
+ *              host drains like LUFA, exit status 1 if any byte is lost
+ *              (needs CONSOLE_ENABLE)
+ *  -k layers   print keymap compiled into tables of this number of layers,
+ *              0 for layers reachable from layer 0
+ *  -K          check compiled keymap against action_for_key() on every
+ *              combination of layers(needs KEYMAP_COMPILED)
+ *
+ * With LATENCY_TRACE_ENABLE latency stats are printed to stderr at the end.
+ *
+ * Trace format: one event per line, '#' starts comment
+ *
+ *      <time ms> <row> <col> <d|u>     key down/up
+ *      <time ms> leds <hex>            indicator LED state from host
+ *
+ * Output format:
+ *
+ *      <time ms> keyboard: <raw report bytes in hex>
+ *      <time ms> mouse: <buttons> <x> <y> <v> <h>
+ *      <time ms> system: <usage>
+ *      <time ms> consumer: <usage>
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <time.h>
+#include "keyboard.h"
+#include "matrix.h"
+#include "action.h"
+#include "action_util.h"
+#include "action_layer.h"
+#include "action_tapping.h"
+#include "action_macro.h"
+#include "host.h"
+#include "timer.h"
+#include "debug.h"
+#include "util.h"
+#include "latency_trace.h"
+#include "hook.h"
+#include "console.h"
+#include "host/timer_host.h"
+#ifdef KEYMAP_COMPILED_ENABLE
+#include "keymap_compiled.h"
+#endif
+
+
+uint8_t keyboard_idle = 0;
+uint8_t keyboard_protocol = 1;
+
+
+/*
+ * Virtual matrix
+ *
+ * Events of trace go to matrix directly. With chatter they go to switch
+ * state instead and contacts bounce for the chatter time after every
+ * change, toggling each 1ms and settling at the new state. Matrix is
+ * updated by matrix_debounce() and each of its changes should follow a
+ * change of switch to the same state.
+ */
+static matrix_row_t matrix[MATRIX_ROWS];
+
+static uint32_t chatter = 0;
+static matrix_row_t switches[MATRIX_ROWS];
+static matrix_row_t bouncing[MATRIX_ROWS];
+static uint32_t bounce_time[MATRIX_ROWS][MATRIX_COLS];
+static matrix_row_t raw[MATRIX_ROWS];
+/* [0]: release, [1]: press not followed by matrix yet and its time */
+static matrix_row_t pending[2][MATRIX_ROWS];
+static uint32_t switch_time[2][MATRIX_ROWS][MATRIX_COLS];
+
+static struct {
+    uint32_t events;    /* changes of switches */
+    uint32_t edges;     /* changes of matrix to state of switches */
+    uint32_t spurious;  /* changes of matrix not caused by switches */
+    uint32_t latency_sum[2];    /* release, press */
+    uint32_t latency_max[2];
+    uint32_t latency_count[2];
+} debounce_stat;
+
+void matrix_init(void)
+{
+    memset(matrix, 0, sizeof(matrix));
+}
+
+static void switch_event(uint8_t row, uint8_t col, bool pressed)
+{
+    matrix_row_t m = ((matrix_row_t)1<<col);
+    if (pressed) {
+        switches[row] |= m;
+    } else {
+        switches[row] &= ~m;
+    }
+    bouncing[row] |= m;
+    bounce_time[row][col] = timer_read32();
+    if (!(pending[pressed][row] & m)) {
+        pending[pressed][row] |= m;
+        switch_time[pressed][row][col] = timer_read32();
+    }
+    debounce_stat.events++;
+}
+
+static void debounce_check(const matrix_row_t prev[])
+{
+    uint32_t now = timer_read32();
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        matrix_row_t changed = prev[r] ^ matrix[r];
+        for (uint8_t c = 0; changed; c++, changed >>= 1) {
+            if (!(changed & 1)) continue;
+
+            matrix_row_t m = ((matrix_row_t)1<<c);
+            bool on = matrix[r] & m;
+            if (!(pending[on][r] & m)) {
+                fprintf(stderr, "%u debounce: spurious %s at %u %u\n", now, on ? "press" : "release", r, c);
+                debounce_stat.spurious++;
+                continue;
+            }
+            pending[on][r] &= ~m;
+            /* event of the other state before this is missed */
+            if (switch_time[!on][r][c] < switch_time[on][r][c]) {
+                pending[!on][r] &= ~m;
+            }
+
+            uint32_t latency = now - switch_time[on][r][c];
+            debounce_stat.edges++;
+            debounce_stat.latency_sum[on] += latency;
+            debounce_stat.latency_count[on]++;
+            if (latency > debounce_stat.latency_max[on]) debounce_stat.latency_max[on] = latency;
+        }
+    }
+}
+
+static void macro_scan(void);
+
+uint8_t matrix_scan(void)
+{
+    macro_scan();
+    if (!chatter) return 1;
+
+    uint32_t now = timer_read32();
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        matrix_row_t bounce = 0;
+        for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+            matrix_row_t m = ((matrix_row_t)1<<c);
+            if (!(bouncing[r] & m)) continue;
+
+            uint32_t t = now - bounce_time[r][c];
+            if (t >= chatter) {
+                bouncing[r] &= ~m;
+            } else if (t & 1) {
+                bounce |= m;
+            }
+        }
+        raw[r] = switches[r] ^ bounce;
+
+        /* switch settled at state of matrix: events in between are missed */
+        matrix_row_t settled = ~bouncing[r] & ~(switches[r] ^ matrix[r]);
+        pending[0][r] &= ~settled;
+        pending[1][r] &= ~settled;
+    }
+
+    matrix_row_t prev[MATRIX_ROWS];
+    memcpy(prev, matrix, sizeof(matrix));
+    if (matrix_debounce(matrix, raw)) {
+        debounce_check(prev);
+    }
+    return 1;
+}
+
+matrix_row_t matrix_get_row(uint8_t row)
+{
+    return matrix[row];
+}
+
+
+/*
+ * Mock host driver
+ */
+static uint8_t leds = 0;
+static uint32_t send_wait = 0;
+/* host takes a keyboard report each poll, reports sent meanwhile are pending */
+static uint32_t poll_interval = 1;
+static uint32_t ep_pending = 0;
+static uint32_t ep_next = 0;    /* time when host takes oldest pending report */
+static bool quiet = false;
+static uint32_t report_count = 0;
+
+static FILE *expected = NULL;
+static uint32_t expected_line = 0;
+static bool mismatch = false;
+
+static void record(const char *line)
+{
+    report_count++;
+    if (quiet) return;
+
+    fputs(line, stdout);
+    if (expected && !mismatch) {
+        char buf[256];
+        expected_line++;
+        if (!fgets(buf, sizeof(buf), expected)) {
+            fprintf(stderr, "expected:%u: <EOF>\n  actual: %s", expected_line, line);
+            mismatch = true;
+        } else if (strcmp(buf, line)) {
+            fprintf(stderr, "expected:%u: %s  actual: %s", expected_line, buf, line);
+            mismatch = true;
+        }
+    }
+}
+
+static uint8_t keyboard_leds(void)
+{
+    return leds;
+}
+
+static void macro_send(uint32_t pending);
+
+static void ep_update(void)
+{
+    uint32_t now = timer_read32();
+    while (ep_pending && (int32_t)(now - ep_next) >= 0) {
+        ep_pending--;
+        ep_next += poll_interval;
+    }
+}
+
+static uint8_t keyboard_pending(void)
+{
+    ep_update();
+    return (ep_pending > 255) ? 255 : ep_pending;
+}
+
+static void send_keyboard(report_keyboard_t *report)
+{
+    ep_update();
+    if (!ep_pending) {
+        uint32_t now = timer_read32();
+        ep_next = now - now % poll_interval + poll_interval;
+    }
+    ep_pending++;
+    macro_send(ep_pending);
+
+    char buf[256];
+    int n = sprintf(buf, "%u keyboard:", timer_read32());
+    uint8_t size = KEYBOARD_REPORT_SIZE;
+#if defined(NKRO_ENABLE) || defined(NKRO_6KRO_ENABLE)
+    if (!(keyboard_protocol && keyboard_nkro)) size = 8;
+#endif
+    for (uint8_t i = 0; i < size; i++) {
+        n += sprintf(buf + n, " %02X", report->raw[i]);
+    }
+    sprintf(buf + n, "\n");
+    record(buf);
+
+    /* emulate driver waiting for endpoint */
+    timer_host_advance_us(send_wait);
+    LATENCY_TRACE(LATENCY_TRACE_ENDPOINT);
+}
+
+static void send_mouse(report_mouse_t *report)
+{
+    char buf[64];
+    sprintf(buf, "%u mouse: %02X %d %d %d %d\n", timer_read32(),
+            report->buttons, report->x, report->y, report->v, report->h);
+    record(buf);
+}
+
+static void send_system(uint16_t data)
+{
+    char buf[64];
+    sprintf(buf, "%u system: %04X\n", timer_read32(), data);
+    record(buf);
+}
+
+static void send_consumer(uint16_t data)
+{
+    char buf[64];
+    sprintf(buf, "%u consumer: %04X\n", timer_read32(), data);
+    record(buf);
+}
+
+static host_driver_t replay_driver = {
+    keyboard_leds,
+    send_keyboard,
+    send_mouse,
+    send_system,
+    send_consumer,
+    keyboard_pending
+};
+
+
+/*
+ * Console
+ *
+ * Like sendchar() of LUFA print output goes into buffer and new bytes are
+ * dropped when it is full. Host takes a packet each 1ms task, and also when
+ * buffer is full in main loop as LUFA sends what endpoint takes at once.
+ * console_yield() of long output waits frames, 1ms each, until half of
+ * buffer is free.
+ */
+#define CONSOLE_PACKET  32
+
+static uint8_t *console_buf = NULL;
+static uint16_t console_size = 0;
+static uint16_t console_head = 0;
+static uint16_t console_used = 0;
+static bool console_packet_ready = false;
+static uint32_t console_total = 0;
+#ifndef NO_PRINT
+static uint16_t console_lost_count = 0;
+#endif
+static uint32_t console_lost_total = 0;
+static uint32_t console_yield_ms = 0;
+
+/* host reads a packet from endpoint bank once a frame */
+static void console_packet(void)
+{
+    if (!console_packet_ready) return;
+    console_packet_ready = false;
+    for (uint8_t i = 0; i < CONSOLE_PACKET && console_used; i++) {
+        fputc(console_buf[(console_head + console_size - console_used) % console_size], stderr);
+        console_used--;
+    }
+}
+
+static void console_frame(void)
+{
+    console_packet_ready = true;
+    console_packet();
+}
+
+#ifndef NO_PRINT
+static void console_putc(uint8_t c)
+{
+    if (console_used == console_size) console_packet();
+    console_total++;
+    if (console_used == console_size) {
+        if (console_lost_count < UINT16_MAX) console_lost_count++;
+        console_lost_total++;
+        return;
+    }
+    console_buf[console_head] = c;
+    console_head = (console_head + 1) % console_size;
+    console_used++;
+}
+#endif
+
+static void console_init(uint16_t size)
+{
+    console_buf = malloc(size);
+    console_size = size;
+#ifndef NO_PRINT
+    xdev_out(console_putc);
+#else
+    fprintf(stderr, "console: CONSOLE_ENABLE is not given\n");
+#endif
+}
+
+static bool console_result(void)
+{
+    while (console_used) console_frame();
+    fprintf(stderr, "console: bytes: %u  lost: %u  yield: %ums\n",
+            console_total, console_lost_total, console_yield_ms);
+    return !console_lost_total;
+}
+
+#ifdef CONSOLE_ENABLE
+uint16_t console_lost(void)
+{
+    return console_lost_count;
+}
+
+void console_clear_lost(void)
+{
+    console_lost_count = 0;
+}
+
+void console_yield(void)
+{
+    while (console_size && console_used >= console_size / 2) {
+        timer_host_advance(1);
+        console_yield_ms++;
+        console_frame();
+    }
+}
+#endif
+
+
+/*
+ * Trace
+ */
+typedef struct {
+    uint32_t time;
+    uint8_t  row;       /* 255: LED state */
+    uint8_t  col;
+    bool     pressed;
+} trace_event_t;
+
+static trace_event_t *trace = NULL;
+static uint32_t trace_len = 0;
+
+static void trace_add(trace_event_t e)
+{
+    static uint32_t cap = 0;
+    if (trace_len == cap) {
+        cap = cap ? cap * 2 : 256;
+        trace = realloc(trace, cap * sizeof(trace_event_t));
+    }
+    trace[trace_len++] = e;
+}
+
+static bool trace_load(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+
+    uint32_t line = 0;
+    char buf[256];
+    while (fgets(buf, sizeof(buf), f)) {
+        line++;
+        char *p = strchr(buf, '#');
+        if (p) *p = '\0';
+
+        unsigned long time;
+        char a[16], b[16], c[16];
+        int n = sscanf(buf, "%lu %15s %15s %15s", &time, a, b, c);
+        if (n <= 0) continue;
+
+        trace_event_t e = { .time = time };
+        if (n == 3 && !strcmp(a, "leds")) {
+            e.row = 255;
+            e.col = strtoul(b, NULL, 16);
+        } else if (n == 4 && (c[0] == 'd' || c[0] == 'u')) {
+            e.row = strtoul(a, NULL, 0);
+            e.col = strtoul(b, NULL, 0);
+            e.pressed = (c[0] == 'd');
+            if (e.row >= MATRIX_ROWS || e.col >= MATRIX_COLS) {
+                fprintf(stderr, "%s:%u: out of matrix\n", path, line);
+                fclose(f);
+                return false;
+            }
+        } else {
+            fprintf(stderr, "%s:%u: syntax error\n", path, line);
+            fclose(f);
+            return false;
+        }
+        if (trace_len && e.time < trace[trace_len - 1].time) {
+            fprintf(stderr, "%s:%u: time goes backward\n", path, line);
+            fclose(f);
+            return false;
+        }
+
+        trace_add(e);
+    }
+    fclose(f);
+    return true;
+}
+
+/*
+ * Rolling keys over the whole matrix: a key is pressed every 10ms and
+ * released after the next 'keys' keys are pressed, 1000 strokes.
+ */
+static void trace_roll(uint8_t keys)
+{
+    const uint32_t strokes = 1000;
+    const uint16_t n = MATRIX_ROWS * MATRIX_COLS;
+    for (uint32_t i = 0; i < strokes + keys; i++) {
+        uint32_t t = 10 * (i + 1);
+        if (i < strokes) {
+            trace_add((trace_event_t){ .time = t, .row = (i % n) / MATRIX_COLS,
+                                       .col = (i % n) % MATRIX_COLS, .pressed = true });
+        }
+        if (i >= keys) {
+            uint32_t j = i - keys;
+            trace_add((trace_event_t){ .time = t + 5, .row = (j % n) / MATRIX_COLS,
+                                       .col = (j % n) % MATRIX_COLS, .pressed = false });
+        }
+    }
+}
+
+
+/*
+ * Replay through keyboard_task() with virtual matrix, 1ms per task call.
+ */
+static void replay(uint32_t tail)
+{
+    for (uint32_t i = 0; i < trace_len; i++) {
+        trace_event_t *e = &trace[i];
+        while (timer_read32() < e->time) {
+            timer_host_advance(1);
+            console_frame();
+            keyboard_task();
+        }
+        if (e->row == 255) {
+            leds = e->col;
+        } else if (chatter) {
+            switch_event(e->row, e->col, e->pressed);
+        } else {
+            if (e->pressed) {
+                matrix[e->row] |= ((matrix_row_t)1<<e->col);
+            } else {
+                matrix[e->row] &= ~((matrix_row_t)1<<e->col);
+            }
+#ifdef MATRIX_DIRTY_ROWS
+            matrix_set_dirty(e->row);
+#endif
+        }
+        keyboard_task();
+    }
+    for (uint32_t t = 0; t < tail; t++) {
+        timer_host_advance(1);
+        console_frame();
+        keyboard_task();
+    }
+}
+
+/*
+ * Result of chatter run: every change of switches should appear on matrix
+ * once and nothing else.
+ */
+static bool debounce_result(void)
+{
+    bool ok = !debounce_stat.spurious;
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        if (matrix[r] != switches[r]) {
+            fprintf(stderr, "debounce: row %u is %08X but switches %08X at end\n",
+                    r, (uint32_t)matrix[r], (uint32_t)switches[r]);
+            ok = false;
+        }
+    }
+
+    fprintf(stderr, "debounce: chatter %ums  events: %u  edges: %u  spurious: %u  missed: %u\n",
+            chatter, debounce_stat.events, debounce_stat.edges, debounce_stat.spurious,
+            debounce_stat.events - debounce_stat.edges);
+    const char *name[2] = { "release", "press  " };
+    for (int on = 1; on >= 0; on--) {
+        uint32_t n = debounce_stat.latency_count[on];
+        fprintf(stderr, "debounce: %s latency(ms) avg: %.2f  max: %u\n", name[on],
+                n ? (double)debounce_stat.latency_sum[on] / n : 0.0,
+                debounce_stat.latency_max[on]);
+    }
+    fprintf(stderr, "debounce: %s\n", ok ? "OK" : "NG");
+    return ok;
+}
+
+
+/*
+ * Macro player
+ *
+ * Macro typing 'a' is played from start of replay while trace goes on. Each
+ * step should take one task call so that matrix is still scanned every 1ms,
+ * a step should wait until host takes report of previous one, and key events
+ * of trace during macro come out after it.
+ */
+static uint32_t macro_steps = 0;
+static struct {
+    uint32_t scans;
+    uint32_t last;      /* time of last scan */
+    uint32_t max_gap;
+    uint32_t max_pending;   /* keyboard reports waiting in driver */
+    uint32_t end;       /* time when player got idle */
+} macro_stat;
+
+static void macro_start(uint32_t steps)
+{
+#ifndef NO_ACTION_MACRO
+    /* a down and up per stroke, so steps is rounded up to even */
+    uint32_t n = (steps + 1) & ~1;
+    macro_t *m = malloc(n + 1);
+    for (uint32_t i = 0; i < n; i++) {
+        m[i] = (i & 1) ? (KC_A | 0x80) : KC_A;
+    }
+    m[n] = END;
+    macro_steps = n;
+    macro_stat.last = timer_read32();
+    action_macro_play(m);
+#else
+    fprintf(stderr, "macro: NO_ACTION_MACRO is defined\n");
+#endif
+}
+
+static void macro_scan(void)
+{
+    if (!macro_steps || macro_stat.end) return;
+
+    uint32_t now = timer_read32();
+    if (now - macro_stat.last > macro_stat.max_gap) macro_stat.max_gap = now - macro_stat.last;
+    macro_stat.last = now;
+    macro_stat.scans++;
+    if (!action_macro_playing()) macro_stat.end = now;
+}
+
+static void macro_send(uint32_t pending)
+{
+    if (!macro_steps || macro_stat.end) return;
+    if (pending > macro_stat.max_pending) macro_stat.max_pending = pending;
+}
+
+static bool macro_result(void)
+{
+    /* a step per poll and scan every frame, and time driver waits */
+    bool ok = macro_stat.end >= (macro_steps - 1) * poll_interval &&
+              macro_stat.max_gap <= 1 + (send_wait + 999) / 1000 &&
+              macro_stat.max_pending <= 1;
+    fprintf(stderr, "macro: steps: %u  time: %ums  scans: %u  max scan gap: %ums  max pending: %u\n",
+            macro_steps, macro_stat.end, macro_stat.scans, macro_stat.max_gap, macro_stat.max_pending);
+    fprintf(stderr, "macro: %s\n", ok ? "OK" : "NG");
+    return ok;
+}
+
+
+/*
+ * Action delay
+ *
+ * Time from matrix scan of key event to process_action() on it. Events wait
+ * in waiting buffer of tapping until tap key is settled, so this is latency
+ * added by tapping.
+ */
+static bool delay_print = false;
+static struct {
+    uint32_t events[2];     /* release, press */
+    uint32_t delayed[2];
+    uint32_t sum[2];
+    uint32_t max[2];
+} delay_stat;
+
+bool hook_process_action(keyrecord_t *record)
+{
+    keyevent_t e = record->event;
+    if (IS_NOEVENT(e)) return false;
+
+    /* time of event is odd */
+    uint16_t delay = (uint16_t)((timer_read() | 1) - e.time);
+    delay_stat.events[e.pressed]++;
+    if (delay) delay_stat.delayed[e.pressed]++;
+    delay_stat.sum[e.pressed] += delay;
+    if (delay > delay_stat.max[e.pressed]) delay_stat.max[e.pressed] = delay;
+    return false;
+}
+
+static void delay_result(void)
+{
+    const char *name[2] = { "release", "press  " };
+    for (int on = 1; on >= 0; on--) {
+        uint32_t n = delay_stat.events[on];
+        fprintf(stderr, "delay: %s events: %u  delayed: %u  avg: %.2fms  max: %ums\n", name[on],
+                n, delay_stat.delayed[on], n ? (double)delay_stat.sum[on] / n : 0.0,
+                delay_stat.max[on]);
+    }
+}
+
+
+/*
+ * Benchmark of action_exec(): no matrix scan, no report output
+ */
+static void bench(uint32_t count)
+{
+    if (!trace_len) return;
+
+    uint32_t span = trace[trace_len - 1].time + TAPPING_TERM + 1;
+    uint32_t events = 0;
+    quiet = true;
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (uint32_t n = 0; n < count; n++) {
+        uint32_t base = n * span;
+        for (uint32_t i = 0; i < trace_len; i++) {
+            trace_event_t *e = &trace[i];
+            if (e->row == 255) continue;
+            timer_host_set(base + e->time);
+            action_exec((keyevent_t){
+                .key = (keypos_t){ .row = e->row, .col = e->col },
+                .pressed = e->pressed,
+                .time = (timer_read() | 1)
+            });
+            events++;
+        }
+        /* settle pending tap */
+        timer_host_set(base + span);
+        action_exec(TICK);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    double sec = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    fprintf(stderr, "events: %u  reports: %u  time: %.6fs  %.0f events/s  %.1f ns/event\n",
+            events, report_count, sec, events / sec, sec * 1e9 / events);
+}
+
+
+/*
+ * Keymap compiler
+ *
+ * Resolves keymap with action_for_key() into tables of KEYMAP_COMPILED
+ * option, see common/keymap_compiled.h. Without number of layers given it
+ * is the top layer reachable from layer 0 through layer actions plus one.
+ */
+static uint8_t keymap_reachable(void)
+{
+    uint32_t found = 1;
+    uint32_t done = 0;
+    while (found & ~done) {
+        uint8_t layer = biton32(found & ~done);
+        done |= (1UL<<layer);
+        for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+            for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+                action_t a = action_for_key(layer, (keypos_t){ .row = r, .col = c });
+                switch (a.kind.id) {
+                    case ACT_LAYER:
+                        /* layers in the nibble, xbit is ignored */
+                        found |= (uint32_t)(a.layer_bitop.bits & 0xf) << (a.layer_bitop.part * 4);
+                        break;
+                    case ACT_LAYER_TAP:
+                    case ACT_LAYER_TAP_EXT:
+                        found |= (1UL<<a.layer_tap.val);
+                        break;
+                }
+            }
+        }
+    }
+    return biton32(found) + 1;
+}
+
+static uint32_t keymap_opaque(uint8_t layers, uint8_t row, uint8_t col)
+{
+    uint32_t opaque = 0;
+    for (uint8_t l = 0; l < layers; l++) {
+        action_t a = action_for_key(l, (keypos_t){ .row = row, .col = col });
+        if (a.code != (action_t)ACTION_TRANSPARENT.code) opaque |= (1UL<<l);
+    }
+    return opaque;
+}
+
+static void keymap_compile(uint8_t layers)
+{
+    if (!layers) layers = keymap_reachable();
+    uint8_t width = (layers <= 8) ? 2 : (layers <= 16) ? 4 : 8;
+
+    printf("/* keymap compiled by host build for KEYMAP_COMPILED, do not edit */\n");
+    printf("#define KEYMAP_COMPILED_LAYERS  %u\n", layers);
+    printf("#define KEYMAP_COMPILED_ROWS    %u\n", MATRIX_ROWS);
+    printf("#define KEYMAP_COMPILED_COLS    %u\n", MATRIX_COLS);
+    printf("\n/* layers where key is not transparent */\n");
+    printf("static const uint%u_t keymap_compiled_opaque[MATRIX_ROWS][MATRIX_COLS] PROGMEM = {\n", width * 4);
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        printf("    {");
+        for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+            printf(" 0x%0*X,", width, keymap_opaque(layers, r, c));
+        }
+        printf(" },\n");
+    }
+    printf("};\n");
+    printf("\nstatic const uint16_t keymap_compiled_actions[KEYMAP_COMPILED_LAYERS][MATRIX_ROWS][MATRIX_COLS] PROGMEM = {\n");
+    for (uint8_t l = 0; l < layers; l++) {
+        printf("    [%u] = {\n", l);
+        for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+            printf("        {");
+            for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+                printf(" 0x%04X,", action_for_key(l, (keypos_t){ .row = r, .col = c }).code);
+            }
+            printf(" },\n");
+        }
+        printf("    },\n");
+    }
+    printf("};\n");
+}
+
+#ifdef KEYMAP_COMPILED_ENABLE
+/* compiled tables against action_for_key() on every combination of layers */
+static bool keymap_compiled_check(void)
+{
+    /* up to 2^16 combinations */
+    uint8_t layers = (keymap_compiled_layers < 16) ? keymap_compiled_layers : 16;
+    uint32_t keys = 0;
+    uint32_t errors = 0;
+    for (uint32_t state = 0; state < (1UL<<layers); state++) {
+        for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+            for (uint8_t c = 0; c < MATRIX_COLS; c++) {
+                keypos_t key = (keypos_t){ .row = r, .col = c };
+
+                /* same as layer_switch_get_action() without compiled keymap */
+                uint8_t layer = 0;
+                for (int8_t i = layers - 1; i >= 0; i--) {
+                    if ((state & (1UL<<i)) &&
+                            action_for_key(i, key).code != (action_t)ACTION_TRANSPARENT.code) {
+                        layer = i;
+                        break;
+                    }
+                }
+                uint16_t expected = action_for_key(layer, key).code;
+
+                uint8_t clayer = keymap_compiled_layer(state, key);
+                uint16_t actual = keymap_compiled_action(clayer, key).code;
+                if (clayer != layer || actual != expected) {
+                    if (errors < 10) {
+                        fprintf(stderr, "keymap: state %08X key %u,%u: expected %u:%04X actual %u:%04X\n",
+                                state, r, c, layer, expected, clayer, actual);
+                    }
+                    errors++;
+                }
+                keys++;
+            }
+        }
+    }
+    fprintf(stderr, "keymap: layers: %u  combinations: %lu  keys: %u  mismatch: %u\n",
+            layers, 1UL<<layers, keys, errors);
+    return errors == 0;
+}
+#endif
+
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [-v] [-e expected] [-b count] [-t tail_ms] [-w us] [-p ms] [-c ms] [-l hex] [-r keys] [-m steps] [-d] [-o bytes] trace\n", name);
+    fprintf(stderr, "       %s -k layers\n", name);
+    fprintf(stderr, "       %s -K\n", name);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t count = 0;
+    uint32_t tail = 1000;
+    uint32_t layers = 0;
+    uint32_t steps = 0;
+    int roll = -1;
+    uint16_t console = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "ve:b:t:w:p:c:l:r:m:do:k:K")) != -1) {
+        switch (opt) {
+            case 'v':
+                debug_enable = true;
+                debug_keyboard = true;
+                break;
+            case 'e':
+                expected = fopen(optarg, "r");
+                if (!expected) {
+                    perror(optarg);
+                    return 2;
+                }
+                break;
+            case 'b':
+                count = strtoul(optarg, NULL, 0);
+                break;
+            case 't':
+                tail = strtoul(optarg, NULL, 0);
+                break;
+            case 'w':
+                send_wait = strtoul(optarg, NULL, 0);
+                replay_driver.keyboard_pending = NULL;
+                break;
+            case 'p':
+                poll_interval = strtoul(optarg, NULL, 0);
+                if (!poll_interval) poll_interval = 1;
+                break;
+            case 'c':
+                chatter = strtoul(optarg, NULL, 0);
+                break;
+            case 'l':
+                layers = strtoul(optarg, NULL, 16);
+                break;
+            case 'r':
+                roll = strtoul(optarg, NULL, 0);
+                break;
+            case 'm':
+                steps = strtoul(optarg, NULL, 0);
+                break;
+            case 'd':
+                delay_print = true;
+                break;
+            case 'o':
+                console = strtoul(optarg, NULL, 0);
+                break;
+            case 'k':
+                keymap_compile(strtoul(optarg, NULL, 0));
+                return 0;
+            case 'K':
+#ifdef KEYMAP_COMPILED_ENABLE
+                return keymap_compiled_check() ? 0 : 1;
+#else
+                fprintf(stderr, "KEYMAP_COMPILED is not given\n");
+                return 2;
+#endif
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+    if (roll >= 0) {
+        if (optind != argc) {
+            usage(argv[0]);
+            return 2;
+        }
+        trace_roll(roll);
+    } else {
+        if (optind != argc - 1) {
+            usage(argv[0]);
+            return 2;
+        }
+        if (!trace_load(argv[optind])) return 2;
+    }
+
+    if (console) {
+        console_init(console);
+    }
+    host_set_driver(&replay_driver);
+    keyboard_setup();
+    keyboard_init();
+#ifndef NO_ACTION_LAYER
+    layer_or(layers);
+#endif
+
+    if (count) {
+        bench(count);
+        return 0;
+    }
+
+    if (steps) {
+        macro_start(steps);
+    }
+    replay(tail);
+#ifdef LATENCY_TRACE_ENABLE
+    latency_trace_print();
+#endif
+    if (chatter && !debounce_result()) {
+        mismatch = true;
+    }
+    if (macro_steps && !macro_result()) {
+        mismatch = true;
+    }
+    if (delay_print) {
+        delay_result();
+    }
+    if (console && !console_result()) {
+        mismatch = true;
+    }
+
+    if (expected && !mismatch) {
+        char buf[256];
+        if (fgets(buf, sizeof(buf), expected)) {
+            fprintf(stderr, "expected:%u: %s  actual: <EOF>\n", expected_line + 1, buf);
+            mismatch = true;
+        }
+    }
+    return mismatch ? 1 : 0;
+}
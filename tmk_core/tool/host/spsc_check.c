@@ -0,0 +1,164 @@
+/*
+ * Stress check of ring buffer between ISR and main loop(common/spsc_ring.h)
+ *
+ *      spsc_check [seconds]
+ *
+ * SIGALRM handler stands for ISR and puts data with sequence number in
+ * bursts while main loop gets them with get, get_batch and peek, and resets
+ * the ring once in a while. The handler interrupts main loop at any
+ * instruction like ISR on single core MCU. Main loop checks that data come
+ * in order without loss, duplicate or torn entry and that count never goes
+ * over size. Both full and empty ring have to be seen during the run.
+ *
+ * Exit status is 1 on any mismatch.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <time.h>
+#include "spsc_ring.h"
+
+
+/* byte ring wraps its index often */
+SPSC_RING_DEFINE(byte_ring, uint8_t, 16)
+/* entry of several bytes is torn if index is updated before data */
+typedef struct {
+    uint16_t seq;
+    uint16_t inv;       // ~seq
+} entry_t;
+SPSC_RING_DEFINE(entry_ring, entry_t, 8)
+
+static byte_ring_t bring;
+static entry_ring_t ering;
+
+/* producer side, touched only by handler */
+static volatile uint8_t  byte_seq = 0;
+static volatile uint16_t entry_seq = 0;
+static volatile unsigned long full = 0;
+static volatile unsigned long alarms = 0;
+
+static unsigned long failed = 0;
+
+
+static void producer(int sig)
+{
+    (void)sig;
+    alarms++;
+    /* burst of one to eight like scan codes of a key */
+    uint8_t n = (alarms * 7) % 8 + 1;
+    for (uint8_t i = 0; i < n; i++) {
+        if (byte_ring_put(&bring, byte_seq)) byte_seq++; else full++;
+        entry_t e = { .seq = entry_seq, .inv = ~entry_seq };
+        if (entry_ring_put(&ering, e)) entry_seq++; else full++;
+    }
+}
+
+static void fail(const char *what, unsigned got, unsigned expected)
+{
+    if (failed++ < 10) printf("NG: %s: got %u, expected %u\n", what, got, expected);
+}
+
+/* consumer side, next sequence number is not known after reset */
+static uint8_t  byte_next = 0;
+static uint16_t entry_next = 0;
+static bool byte_sync = true;
+static bool entry_sync = true;
+static unsigned long got = 0;
+
+static void check_byte(const char *what, uint8_t b)
+{
+    if (byte_sync && b != byte_next) fail(what, b, byte_next);
+    byte_next = b + 1;
+    byte_sync = true;
+    got++;
+}
+
+static void check_entry(const char *what, entry_t e)
+{
+    if ((uint16_t)(e.seq ^ e.inv) != 0xFFFF) fail("entry torn", e.seq, (uint16_t)~e.inv);
+    if (entry_sync && e.seq != entry_next) fail(what, e.seq, entry_next);
+    entry_next = e.seq + 1;
+    entry_sync = true;
+    got++;
+}
+
+/* some work of main loop between gets */
+static void busy(unsigned long n)
+{
+    for (volatile unsigned long i = 0; i < n; i++) ;
+}
+
+
+int main(int argc, char *argv[])
+{
+    int seconds = (argc > 1) ? atoi(argv[1]) : 2;
+    if (seconds <= 0) seconds = 2;
+
+    struct sigaction sa = { .sa_handler = producer };
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGALRM, &sa, NULL);
+    struct itimerval it = { .it_interval = { 0, 50 }, .it_value = { 0, 50 } };
+    setitimer(ITIMER_REAL, &it, NULL);
+
+    unsigned long empty = 0, resets = 0;
+    time_t end = time(NULL) + seconds;
+
+    for (unsigned long loop = 0; time(NULL) < end; loop++) {
+        uint8_t c = byte_ring_count(&bring);
+        if (c > 16) fail("byte count", c, 16);
+        c = entry_ring_count(&ering);
+        if (c > 8) fail("entry count", c, 8);
+
+        uint8_t b;
+        entry_t e;
+        switch (loop % 4) {
+        case 0:
+            /* one at a time */
+            while (byte_ring_get(&bring, &b)) check_byte("byte get", b);
+            while (entry_ring_get(&ering, &e)) check_entry("entry get", e);
+            empty++;
+            break;
+        case 1: {
+            /* batch less than size */
+            uint8_t buf[5];
+            uint8_t n = byte_ring_get_batch(&bring, buf, sizeof(buf));
+            for (uint8_t i = 0; i < n; i++) check_byte("byte batch", buf[i]);
+            entry_t ebuf[8];
+            n = entry_ring_get_batch(&ering, ebuf, 8);
+            for (uint8_t i = 0; i < n; i++) check_entry("entry batch", ebuf[i]);
+            break;
+        }
+        case 2:
+            /* peek gives what get gives next */
+            if (byte_ring_peek(&bring, &b)) {
+                uint8_t g = ~b;
+                if (!byte_ring_get(&bring, &g) || g != b) fail("byte peek", g, b);
+                check_byte("byte peek", b);
+            }
+            /* slow main loop lets ring fill up */
+            busy(20000);
+            break;
+        case 3:
+            if (loop % 1024 == 3) {
+                /* data after reset go on from any sequence number */
+                byte_ring_reset(&bring);
+                entry_ring_reset(&ering);
+                byte_sync = entry_sync = false;
+                resets++;
+            }
+            break;
+        }
+    }
+
+    struct itimerval stop = {};
+    setitimer(ITIMER_REAL, &stop, NULL);
+
+    printf("spsc: alarms:%lu got:%lu full:%lu empty:%lu resets:%lu\n", alarms, got, full, empty, resets);
+    if (!full) fail("full ring seen", 0, 1);
+    if (!got) fail("data got", 0, 1);
+    printf("spsc: %s\n", failed ? "NG" : "OK");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,259 @@
+/*
+ * Decoder of tokenized log(common/tlog.c)
+ *
+ *      tlog_decode firmware.elf [log]
+ *
+ * Reads console output from log file or stdin and writes it to stdout with
+ * records replaced by text formatted with strings found in the ELF file.
+ * Other text passes through. Formatting follows AVR xprintf: int is 16-bit,
+ * long 32-bit and %b is binary.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <elf.h>
+
+#define TLOG_FRAME_START    0x01
+#define TLOG_ID_LOST        0xFFFF
+
+
+typedef struct {
+    uint64_t addr;
+    uint64_t size;
+    uint64_t offset;
+} section_t;
+
+static uint8_t *elf;
+static size_t elf_size;
+static section_t *sections;
+static int num_sections;
+/* ID is offset from this */
+static uint64_t fmt_base = 0;
+
+
+static int load_elf(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) { perror(path); return -1; }
+    fseek(f, 0, SEEK_END);
+    elf_size = ftell(f);
+    rewind(f);
+    elf = malloc(elf_size);
+    if (!elf || fread(elf, 1, elf_size, f) != elf_size) {
+        fprintf(stderr, "%s: read error\n", path);
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+
+    if (elf_size < EI_NIDENT || memcmp(elf, ELFMAG, SELFMAG) || elf[EI_DATA] != ELFDATA2LSB) {
+        fprintf(stderr, "%s: not little endian ELF\n", path);
+        return -1;
+    }
+
+    /* headers of both classes into common form */
+    uint64_t shoff;
+    int shnum, shstrndx;
+    size_t shentsize;
+    int is64 = (elf[EI_CLASS] == ELFCLASS64);
+    if (is64) {
+        Elf64_Ehdr *eh = (Elf64_Ehdr *)elf;
+        shoff = eh->e_shoff; shnum = eh->e_shnum; shstrndx = eh->e_shstrndx; shentsize = sizeof(Elf64_Shdr);
+    } else {
+        Elf32_Ehdr *eh = (Elf32_Ehdr *)elf;
+        shoff = eh->e_shoff; shnum = eh->e_shnum; shstrndx = eh->e_shstrndx; shentsize = sizeof(Elf32_Shdr);
+    }
+    if (shoff + (uint64_t)shnum * shentsize > elf_size || shstrndx >= shnum) {
+        fprintf(stderr, "%s: broken section header\n", path);
+        return -1;
+    }
+
+    sections = calloc(shnum, sizeof(section_t));
+    uint64_t strtab = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < shnum; i++) {
+            uint8_t *p = elf + shoff + i * shentsize;
+            uint32_t name, type;
+            uint64_t flags, addr, offset, size;
+            if (is64) {
+                Elf64_Shdr *sh = (Elf64_Shdr *)p;
+                name = sh->sh_name; type = sh->sh_type; flags = sh->sh_flags;
+                addr = sh->sh_addr; offset = sh->sh_offset; size = sh->sh_size;
+            } else {
+                Elf32_Shdr *sh = (Elf32_Shdr *)p;
+                name = sh->sh_name; type = sh->sh_type; flags = sh->sh_flags;
+                addr = sh->sh_addr; offset = sh->sh_offset; size = sh->sh_size;
+            }
+
+            if (pass == 0) {
+                if (i == shstrndx) strtab = offset;
+                continue;
+            }
+
+            if (strtab + name < elf_size && !strcmp((char *)elf + strtab + name, "tlog_fmt")) {
+                fmt_base = addr;
+            }
+            if (type != SHT_PROGBITS || !(flags & SHF_ALLOC) || offset + size > elf_size) continue;
+            sections[num_sections++] = (section_t){ .addr = addr, .size = size, .offset = offset };
+        }
+    }
+    return 0;
+}
+
+static const char *find_fmt(uint16_t id)
+{
+    uint64_t addr = fmt_base + id;
+    for (int i = 0; i < num_sections; i++) {
+        section_t *s = &sections[i];
+        if (addr < s->addr || addr >= s->addr + s->size) continue;
+        const char *fmt = (const char *)elf + s->offset + (addr - s->addr);
+        /* must be terminated within section */
+        if (!memchr(fmt, '\0', s->size - (addr - s->addr))) return NULL;
+        return fmt;
+    }
+    return NULL;
+}
+
+
+static void print_num(uint32_t v, int radix, int is_signed, int is_long, char pad, int width)
+{
+    char buf[40];
+    int n = 0;
+    int neg = 0;
+    if (is_signed) {
+        int32_t s = is_long ? (int32_t)v : (int16_t)v;
+        if (s < 0) { neg = 1; v = -s; }
+    }
+    do {
+        int d = v % radix;
+        buf[n++] = d < 10 ? '0' + d : 'A' + d - 10;
+        v /= radix;
+    } while (v);
+    if (neg) {
+        if (pad == '0') { putchar('-'); width--; }
+        else buf[n++] = '-';
+    }
+    while (n < width--) putchar(pad);
+    while (n) putchar(buf[--n]);
+}
+
+static void print_record(const char *fmt, const uint8_t *arg, int len)
+{
+    char c;
+    while ((c = *fmt++)) {
+        if (c != '%') { putchar(c); continue; }
+
+        char pad = ' ';
+        int width = 0;
+        int is_long = 0;
+        c = *fmt++;
+        if (c == '0') { pad = '0'; c = *fmt++; }
+        while (c >= '0' && c <= '9') { width = width * 10 + (c - '0'); c = *fmt++; }
+        if (c == 'l') { is_long = 1; c = *fmt++; }
+        if (!c) break;
+
+        int radix = 0, is_signed = 0, size = is_long ? 4 : 2;
+        switch (c) {
+            case 'c':
+                if (len < 1) goto truncated;
+                putchar(*arg);
+                arg++; len--;
+                continue;
+            case 's':
+            case 'S': {
+                const uint8_t *end = memchr(arg, '\0', len);
+                if (!end) goto truncated;
+                int n = end - arg;
+                while (n < width--) putchar(' ');
+                fputs((const char *)arg, stdout);
+                len -= n + 1; arg = end + 1;
+                continue;
+            }
+            case 'b': radix = 2; break;
+            case 'o': radix = 8; break;
+            case 'd': radix = 10; is_signed = 1; break;
+            case 'u': radix = 10; break;
+            case 'x':
+            case 'X': radix = 16; break;
+            default:
+                putchar(c);
+                continue;
+        }
+
+        if (len < size) goto truncated;
+        uint32_t v = 0;
+        for (int i = size - 1; i >= 0; i--) v = (v << 8) | arg[i];
+        arg += size; len -= size;
+        print_num(v, radix, is_signed, is_long, pad, width);
+    }
+    return;
+
+truncated:
+    fputs("...\n", stdout);
+}
+
+/* returns length decoded or -1 on error */
+static int cobs_decode(const uint8_t *in, int len, uint8_t *out)
+{
+    int n = 0;
+    for (int i = 0; i < len; ) {
+        uint8_t code = in[i++];
+        if (code == 0 || i + code - 1 > len) return -1;
+        for (int k = 1; k < code; k++) out[n++] = in[i++];
+        if (i < len) out[n++] = 0;
+    }
+    return n;
+}
+
+static void decode(FILE *in)
+{
+    int c;
+    while ((c = getc(in)) != EOF) {
+        if (c != TLOG_FRAME_START) {
+            putchar(c);
+            continue;
+        }
+
+        int len = getc(in);
+        if (len == EOF) break;
+        uint8_t frame[256], rec[256];
+        if (fread(frame, 1, len, in) != (size_t)len) break;
+        int n = cobs_decode(frame, len, rec);
+        if (n < 2) {
+            fputs("[tlog: broken record]\n", stdout);
+            continue;
+        }
+
+        uint16_t id = rec[0] | (rec[1] << 8);
+        if (id == TLOG_ID_LOST && n == 4) {
+            printf("[tlog: %u records dropped]\n", rec[2] | (rec[3] << 8));
+            continue;
+        }
+        const char *fmt = find_fmt(id);
+        if (!fmt) {
+            printf("[tlog: unknown id %04X]\n", id);
+            continue;
+        }
+        print_record(fmt, rec + 2, n - 2);
+    }
+    fflush(stdout);
+}
+
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "usage: %s firmware.elf [log]\n", argv[0]);
+        return 2;
+    }
+    if (load_elf(argv[1])) return 1;
+
+    FILE *in = stdin;
+    if (argc == 3 && !(in = fopen(argv[2], "rb"))) {
+        perror(argv[2]);
+        return 1;
+    }
+    decode(in);
+    return 0;
+}